@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Times every dispatched DSP kernel for every instruction set this machine runs
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../../Source/CpuDispatch.h"
+#include "../../Source/StereoKernel.h"
+#include "../../Source/Metering.h"
+#include "../../Source/SpectrumMath.h"
+#include "../../Source/HalfBandDecimator.h"
+#include "../../Source/ResponseEvaluator.h"
+
+#include <functional>
+
+//best of numRepeats timings of run, prepare restores the input before each one and is not timed
+static double timeBest(int numRepeats, const std::function<void()>& prepare, const std::function<void()>& run){
+    double bestSeconds = std::numeric_limits<double>::max();
+    for(int repeat = 0; repeat < numRepeats; ++repeat){
+        prepare();
+        auto start = juce::Time::getHighResolutionTicks();
+        run();
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        bestSeconds = juce::jmin(bestSeconds, seconds);
+    }
+    return bestSeconds;
+}
+
+//times one kernel at every supported level and returns a heading plus one line per level with its throughput and
+//its speed up over the scalar build, timeLevel returns the best time for numItems items at the given level
+static juce::String reportKernel(const juce::String& name, const juce::String& unit, int numItems,
+                                 const std::function<double(IsaLevel)>& timeLevel){
+    juce::String report;
+    report << name << "\n";
+
+    double scalarRate = 0.0;
+    for(auto isa : {IsaLevel::Scalar, IsaLevel::SSE2, IsaLevel::AVX2, IsaLevel::NEON}){
+        if(! isIsaSupported(isa)){
+            continue;
+        }
+
+        auto itemsPerSecond = numItems / timeLevel(isa);
+        if(isa == IsaLevel::Scalar){
+            scalarRate = itemsPerSecond;
+        }
+        report << "    " << getIsaName(isa).paddedRight(' ', 8)
+               << juce::String(itemsPerSecond / 1.0e6, 1) << " M " << unit << "/s  ("
+               << juce::String(itemsPerSecond / scalarRate, 2) << "x scalar)\n";
+    }
+
+    return report;
+}
+
+static void fillNoise(float* samples, int numSamples, juce::Random& random){
+    for(int i = 0; i < numSamples; ++i){
+        samples[i] = random.nextFloat() * 2.f - 1.f;
+    }
+}
+
+//full 9 section cascade on a stereo block, M/S so the fused encode/decode is included in the timing
+static juce::String benchmarkStereoSections(int numSamples, int numRepeats){
+    StereoCascade cascade;
+    std::array<int, MaxCascadeSlots> slots;
+    for(int slot = 0; slot < MaxCascadeSlots; ++slot){
+        auto& section = cascade.sections[slot];
+        section.b0 = {0.2f, 0.21f};
+        section.b1 = {0.4f, 0.39f};
+        section.b2 = {0.2f, 0.22f};
+        section.a1 = {-0.6f, -0.61f};
+        section.a2 = {0.2f, 0.19f};
+        slots[slot] = slot;
+    }
+
+    juce::AudioBuffer<float> input(2, numSamples), work(2, numSamples);
+    juce::Random random(1);
+    for(int ch = 0; ch < 2; ++ch){
+        fillNoise(input.getWritePointer(ch), numSamples, random);
+    }
+
+    return reportKernel("stereo sections, 9 sections M/S", "stereo samples", numSamples, [&](IsaLevel isa){
+        auto kernel = getStereoSectionsKernel(isa);
+        StereoCascadeState state {};
+        return timeBest(numRepeats, [&]{ work.makeCopyOf(input, true); }, [&]{
+            kernel(cascade.sections.data(), state, slots.data(), MaxCascadeSlots,
+                   work.getWritePointer(0), work.getWritePointer(1), numSamples, true, true);
+        });
+    });
+}
+
+static juce::String benchmarkBlockSums(int numSamples, int numRepeats){
+    std::vector<float> left(static_cast<size_t>(numSamples)), right(static_cast<size_t>(numSamples));
+    juce::Random random(2);
+    fillNoise(left.data(), numSamples, random);
+    fillNoise(right.data(), numSamples, random);
+
+    StereoBlockSums sums;
+    return reportKernel("meter block sums", "stereo samples", numSamples, [&](IsaLevel isa){
+        auto kernel = getStereoBlockSumsKernel(isa);
+        return timeBest(numRepeats, []{}, [&]{ sums = kernel(left.data(), right.data(), numSamples); });
+    });
+}
+
+//the analyzer's conversions on one FFT's worth of bins at a time, as many as there are samples in the block
+static juce::String benchmarkSpectrumMath(int numSamples, int numRepeats){
+    auto numBins = juce::jmax(1, numSamples / 2);
+    std::vector<float> interleaved(static_cast<size_t>(2 * numBins)), power(static_cast<size_t>(numBins)),
+                       decibels(static_cast<size_t>(numBins));
+    juce::Random random(3);
+    fillNoise(interleaved.data(), 2 * numBins, random);
+
+    //every build writes the same powers, which the decibel conversion then reads
+    auto report = reportKernel("bin powers", "bins", numBins, [&](IsaLevel isa){
+        auto kernel = getBinPowersKernel(isa);
+        return timeBest(numRepeats, []{}, [&]{ kernel(interleaved.data(), power.data(), numBins); });
+    });
+    report << reportKernel("power to decibels", "values", numBins, [&](IsaLevel isa){
+        auto kernel = getDecibelsKernel(isa);
+        return timeBest(numRepeats, []{}, [&]{ kernel(power.data(), decibels.data(), numBins, 1.f, -60.f); });
+    });
+    return report;
+}
+
+//one channel through a decimator in the FIFO frames the analyzer feeds it with
+static juce::String benchmarkDecimator(int numSamples, int numRepeats){
+    constexpr int FrameSize = 256;
+    std::vector<float> input(static_cast<size_t>(numSamples)), work(input.size());
+    juce::Random random(4);
+    fillNoise(input.data(), numSamples, random);
+
+    return reportKernel("half-band decimator", "input samples", numSamples, [&](IsaLevel isa){
+        HalfBandDecimator decimator;
+        decimator.setIsaLevel(isa);
+        return timeBest(numRepeats, [&]{ work = input; }, [&]{
+            for(int start = 0; start < numSamples; start += FrameSize){
+                auto* frame = work.data() + start;
+                decimator.process(frame, juce::jmin(FrameSize, numSamples - start), frame);
+            }
+        });
+    });
+}
+
+//the curve worker's evaluation of a whole cascade at every column of a wide plot
+static juce::String benchmarkSectionResponse(int numRepeats){
+    constexpr int NumColumns = 1024;
+    std::vector<double> frequencies;
+    for(int i = 0; i < NumColumns; ++i){
+        frequencies.push_back(juce::mapToLog10(static_cast<double>(i) / NumColumns, 20.0, 20000.0));
+    }
+    ResponseTable table;
+    table.build(frequencies, 48000.0);
+
+    std::array<StereoSection, MaxCascadeSlots> sections;
+    for(auto& section : sections){
+        section.b0 = {0.2f, 0.21f};
+        section.b1 = {0.4f, 0.39f};
+        section.b2 = {0.2f, 0.22f};
+        section.a1 = {-0.6f, -0.61f};
+        section.a2 = {0.2f, 0.19f};
+    }
+
+    ResponseColumns response;
+    return reportKernel("section response, 9 sections", "columns", NumColumns, [&](IsaLevel isa){
+        auto kernel = getSectionResponseKernel(isa);
+        return timeBest(numRepeats, [&]{ response.reset(NumColumns); }, [&]{
+            kernel(sections.data(), MaxCascadeSlots, 0, table, response);
+        });
+    });
+}
+
+//usage: SimpleEQBenchmark [numSamples] [numRepeats]
+int main(int argc, char* argv[]){
+    auto numSamples = argc > 1 ? juce::jmax(1, juce::String(argv[1]).getIntValue()) : 1 << 16;
+    auto numRepeats = argc > 2 ? juce::jmax(1, juce::String(argv[2]).getIntValue()) : 50;
+
+    std::cout << "selected: " << getIsaName(selectIsaLevel()) << "\n"
+              << benchmarkStereoSections(numSamples, numRepeats)
+              << benchmarkBlockSums(numSamples, numRepeats)
+              << benchmarkSpectrumMath(numSamples, numRepeats)
+              << benchmarkDecimator(numSamples, numRepeats)
+              << benchmarkSectionResponse(numRepeats);
+    return 0;
+}
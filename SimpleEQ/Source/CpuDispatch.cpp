@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    CpuDispatch.cpp
+    Picks the instruction set the DSP kernels run with
+
+  ==============================================================================
+*/
+
+#include "CpuDispatch.h"
+
+#include <atomic>
+
+//-1 means no override
+static std::atomic<int> isaOverride { -1 };
+
+juce::String getIsaName(IsaLevel isa){
+    switch(isa){
+        case IsaLevel::SSE2: return "SSE2";
+        case IsaLevel::AVX2: return "AVX2";
+        case IsaLevel::NEON: return "NEON";
+        case IsaLevel::Scalar:
+        default: return "Scalar";
+    }
+}
+
+bool isIsaSupported(IsaLevel isa){
+    switch(isa){
+        case IsaLevel::Scalar:
+            return true;
+       #if JUCE_INTEL
+        case IsaLevel::SSE2:
+            return juce::SystemStats::hasSSE2();
+       #endif
+       #if SIMPLEEQ_AVX2
+        case IsaLevel::AVX2:
+            return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+       #endif
+       #if JUCE_ARM && defined(__ARM_NEON)
+        case IsaLevel::NEON:
+            return true;
+       #endif
+        default:
+            return false;
+    }
+}
+
+IsaLevel detectIsaLevel(){
+    for(auto isa : {IsaLevel::AVX2, IsaLevel::SSE2, IsaLevel::NEON}){
+        if(isIsaSupported(isa)){
+            return isa;
+        }
+    }
+    return IsaLevel::Scalar;
+}
+
+void setIsaOverride(IsaLevel isa){
+    isaOverride.store(static_cast<int>(isa));
+}
+
+void clearIsaOverride(){
+    isaOverride.store(-1);
+}
+
+//maps the SIMPLEEQ_ISA environment variable to a level, -1 if it is unset or unknown
+static int getEnvironmentOverride(){
+    auto name = juce::SystemStats::getEnvironmentVariable("SIMPLEEQ_ISA", {}).trim().toLowerCase();
+    for(auto isa : {IsaLevel::Scalar, IsaLevel::SSE2, IsaLevel::AVX2, IsaLevel::NEON}){
+        if(name.isNotEmpty() && name == getIsaName(isa).toLowerCase()){
+            return static_cast<int>(isa);
+        }
+    }
+    return -1;
+}
+
+IsaLevel selectIsaLevel(){
+    auto forced = isaOverride.load();
+    if(forced < 0){
+        forced = getEnvironmentOverride();
+    }
+
+    if(forced >= 0 && isIsaSupported(static_cast<IsaLevel>(forced))){
+        return static_cast<IsaLevel>(forced);
+    }
+    return detectIsaLevel();
+}
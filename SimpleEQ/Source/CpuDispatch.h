@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    CpuDispatch.h
+    Picks the instruction set the DSP kernels run with
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//AVX2 kernels are compiled function by function, with target attributes on GCC and Clang (MSVC takes the intrinsics
+//without flags), so the rest of the plugin keeps the baseline instruction set and they only run when cpuid says so
+//SIMPLEEQ_TARGET_AVX2 goes in front of every function that uses AVX2 or FMA intrinsics, lambdas do not inherit it
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG)
+ #define SIMPLEEQ_AVX2 1
+ #define SIMPLEEQ_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#elif JUCE_INTEL && JUCE_MSVC
+ #define SIMPLEEQ_AVX2 1
+ #define SIMPLEEQ_TARGET_AVX2
+#else
+ #define SIMPLEEQ_AVX2 0
+#endif
+
+//instruction set levels a kernel can be built for, higher levels on the same architecture include the lower ones
+//AVX2 means AVX2 and FMA3 together, as on every Intel and AMD core with AVX2
+enum class IsaLevel{
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+juce::String getIsaName(IsaLevel isa);
+
+//true if this build contains kernels for the level and the CPU can run them
+bool isIsaSupported(IsaLevel isa);
+
+//best level the CPU supports, from cpuid on Intel (through juce::SystemStats) and at compile time on ARM
+IsaLevel detectIsaLevel();
+
+//forces a level for testing, e.g. to compare outputs between kernels
+//the SIMPLEEQ_ISA environment variable (scalar, sse2, avx2, neon) does the same without a rebuild
+//unsupported levels fall back to the detected one
+void setIsaOverride(IsaLevel isa);
+void clearIsaOverride();
+
+//detected level unless overridden, called from prepareToPlay so the choice is made once per playback setup
+IsaLevel selectIsaLevel();
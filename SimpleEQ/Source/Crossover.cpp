@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    Crossover.cpp
+    3-way Linkwitz-Riley split built from the low and high cut frequencies
+
+  ==============================================================================
+*/
+
+#include "Crossover.h"
+#include "StereoDesign.h"
+
+//a 12 dB/Oct high cut design is exactly the Butterworth (Q = 1/sqrt2) section an LR4 split is made of
+static void designSplit(StereoSection& lowPass, StereoSection& allPass, double sampleRate, const std::array<float, 2>& freq){
+    std::array<StereoSection, 4> sections;
+    designCutSections(sections.data(), false, sampleRate, freq, {0, 0}, 2);
+    lowPass = sections[0];
+
+    //the allpass shares the low pass denominator, its numerator is the denominator reversed
+    allPass.a1 = lowPass.a1;
+    allPass.a2 = lowPass.a2;
+    allPass.b0 = lowPass.a2;
+    allPass.b1 = lowPass.a1;
+    allPass.b2 = {1.f, 1.f};
+}
+
+void StereoCrossover::design(double sampleRate, const std::array<float, 2>& lowSplit, const std::array<float, 2>& highSplit){
+    std::array<float, 2> upper;
+    for(int lane = 0; lane < 2; ++lane){
+        upper[lane] = juce::jmax(highSplit[lane], lowSplit[lane]);
+    }
+
+    designSplit(lowPass1, allPass1, sampleRate, lowSplit);
+    designSplit(lowPass2, allPass2, sampleRate, upper);
+}
+
+void StereoCrossover::reset(){
+    state = {};
+}
+
+//one transposed direct form II step for a single lane
+static inline float tick(const StereoSection& c, StereoSectionState& z, int lane, float x){
+    auto y = c.b0[lane] * x + z.z1[lane];
+    z.z1[lane] = c.b1[lane] * x - c.a1[lane] * y + z.z2[lane];
+    z.z2[lane] = c.b2[lane] * x - c.a2[lane] * y;
+    return y;
+}
+
+void StereoCrossover::process(float* left, float* right, const CrossoverOutputs& outputs, int numSamples){
+    std::array<float*, 2> io {left, right};
+    //a mono layout passes the same buffer twice, only one lane runs so the output is not split a second time
+    auto numLanes = left == right ? 1 : 2;
+
+    for(int i = 0; i < numSamples; ++i){
+        for(int lane = 0; lane < numLanes; ++lane){
+            auto x = io[lane][i];
+
+            auto lowPassed = tick(lowPass1, state[LowPass1B], lane, tick(lowPass1, state[LowPass1A], lane, x));
+            auto rest = tick(allPass1, state[AllPass1], lane, x) - lowPassed;
+
+            auto mid = tick(lowPass2, state[LowPass2B], lane, tick(lowPass2, state[LowPass2A], lane, rest));
+            auto high = tick(allPass2, state[AllPass2Rest], lane, rest) - mid;
+            auto low = tick(allPass2, state[AllPass2Low], lane, lowPassed);
+
+            if(outputs.low[lane] != nullptr){
+                outputs.low[lane][i] = low;
+            }
+            if(outputs.mid[lane] != nullptr){
+                outputs.mid[lane][i] = mid;
+            }
+            if(outputs.high[lane] != nullptr){
+                outputs.high[lane][i] = high;
+            }
+
+            io[lane][i] = low + mid + high;
+        }
+    }
+}
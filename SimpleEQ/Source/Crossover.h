@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    Crossover.h
+    3-way Linkwitz-Riley split built from the low and high cut frequencies
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StereoKernel.h"
+
+//band outputs of the crossover, a null pointer means that band's bus is disabled for that lane
+struct CrossoverOutputs{
+    std::array<float*, 2> low {}, mid {}, high {};
+};
+
+//an LR4 split is two identical Butterworth (Q = 1/sqrt2) sections, and LR4 low pass + LR4 high pass sums to the
+//second order allpass with the same denominator, so the high side of each split is taken as allpass(x) - lowpass(x)
+//instead of running its own cascade
+//
+//    low  = AP2(LP1(LP1(x)))          AP2 keeps the low band in phase with the mid/high split above it
+//    rest = AP1(x) - LP1(LP1(x))
+//    mid  = LP2(LP2(rest))
+//    high = AP2(rest) - mid
+//
+//which costs 7 sections per lane for all three bands, and low + mid + high is flat (AP2(AP1(x)))
+struct StereoCrossover{
+    //per lane split frequencies, the upper split is kept above the lower one
+    void design(double sampleRate, const std::array<float, 2>& lowSplit, const std::array<float, 2>& highSplit);
+
+    void reset();
+
+    //replaces left/right with the sum of the bands and writes each enabled band into its output
+    void process(float* left, float* right, const CrossoverOutputs& outputs, int numSamples);
+
+private:
+    StereoSection lowPass1, allPass1, lowPass2, allPass2;
+
+    enum States{
+        LowPass1A,
+        LowPass1B,
+        AllPass1,
+        LowPass2A,
+        LowPass2B,
+        AllPass2Rest,
+        AllPass2Low,
+        NumStates
+    };
+    std::array<StereoSectionState, NumStates> state;
+};
@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    CurveSampler.cpp
+    Adaptive column sampling of smooth curves with monotone cubic reconstruction
+
+  ==============================================================================
+*/
+
+#include "CurveSampler.h"
+
+#include <algorithm>
+
+void CurveSampler::setTrace(int trace, float newPixelsPerUnit, float newPeriod, float newFloor){
+    pixelsPerUnit[static_cast<size_t>(trace)] = newPixelsPerUnit;
+    period[static_cast<size_t>(trace)] = newPeriod;
+    floor[static_cast<size_t>(trace)] = newFloor;
+}
+
+//both ends, a grid of MaxSpacing columns and the seeds, so the first round already covers every feature
+void CurveSampler::begin(int newNumColumns, int newNumTraces, const std::vector<int>& seeds){
+    numColumns = newNumColumns;
+    numTraces = juce::jlimit(1, MaxTraces, newNumTraces);
+    samples.clear();
+    checking.clear();
+    pending.clear();
+    if(numColumns <= 0){
+        return;
+    }
+
+    for(int t = 0; t < numTraces; ++t){
+        values[static_cast<size_t>(t)].assign(static_cast<size_t>(numColumns), 0.f);
+    }
+
+    for(int column = 0; column < numColumns; column += MaxSpacing){
+        pending.push_back(column);
+    }
+    pending.push_back(numColumns - 1);
+    for(auto seed : seeds){
+        if(seed >= 0 && seed < numColumns){
+            pending.push_back(seed);
+        }
+    }
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+}
+
+void CurveSampler::supply(const std::array<const float*, MaxTraces>& newValues){
+    //first round: nothing to check yet, wrapped traces are unwrapped left to right
+    if(samples.empty()){
+        for(int t = 0; t < numTraces; ++t){
+            auto& trace = values[static_cast<size_t>(t)];
+            auto p = period[static_cast<size_t>(t)];
+            for(size_t k = 0; k < pending.size(); ++k){
+                auto value = newValues[static_cast<size_t>(t)][k];
+                if(p > 0.f && k > 0){
+                    auto previous = trace[static_cast<size_t>(pending[k - 1])];
+                    value = previous + std::remainder(value - previous, p);
+                }
+                trace[static_cast<size_t>(pending[k])] = value;
+            }
+        }
+        samples.swap(pending);
+        checking.clear();
+        for(size_t k = 0; k + 1 < samples.size(); ++k){
+            if(samples[k + 1] - samples[k] >= 2){
+                checking.push_back(samples[k]);
+            }
+        }
+        queueChecks();
+        return;
+    }
+
+    //later rounds: every checked interval either passes as a whole or is split at all of its check points
+    nextChecking.clear();
+    for(size_t j = 0; j < checking.size(); ++j){
+        auto left = checking[j];
+        auto index = static_cast<size_t>(std::lower_bound(samples.begin(), samples.end(), left) - samples.begin());
+        auto right = samples[index + 1];
+        auto first = static_cast<size_t>(checkStarts[j]), last = static_cast<size_t>(checkStarts[j + 1]);
+
+        auto failed = false;
+        for(size_t k = first; k < last; ++k){
+            auto column = pending[k];
+            for(int t = 0; t < numTraces; ++t){
+                auto& trace = values[static_cast<size_t>(t)];
+                auto value = newValues[static_cast<size_t>(t)][k];
+                auto p = period[static_cast<size_t>(t)];
+                if(p > 0.f){
+                    auto previous = trace[static_cast<size_t>(left)];
+                    value = previous + std::remainder(value - previous, p);
+                }
+                auto lowest = floor[static_cast<size_t>(t)];
+                auto predicted = juce::jmax(lowest, interpolate(t, index, static_cast<float>(column)));
+                auto error = std::abs(predicted - juce::jmax(lowest, value)) * pixelsPerUnit[static_cast<size_t>(t)];
+                failed = failed || error > TolerancePixels;
+                trace[static_cast<size_t>(column)] = value;
+            }
+        }
+
+        //passing check points are still kept as samples, they only stop the interval from being split further
+        if(failed){
+            auto start = left;
+            for(size_t k = first; k <= last; ++k){
+                auto end = k < last ? pending[k] : right;
+                if(end - start >= 2){
+                    nextChecking.push_back(start);
+                }
+                start = end;
+            }
+        }
+    }
+
+    merged.resize(samples.size() + pending.size());
+    std::merge(samples.begin(), samples.end(), pending.begin(), pending.end(), merged.begin());
+    samples.swap(merged);
+    checking.swap(nextChecking);
+    queueChecks();
+}
+
+//a third and two thirds into every interval in checking, in order, only the middle one for a gap of two columns
+void CurveSampler::queueChecks(){
+    pending.clear();
+    checkStarts.clear();
+    for(auto left : checking){
+        auto index = std::lower_bound(samples.begin(), samples.end(), left) - samples.begin();
+        auto right = samples[static_cast<size_t>(index) + 1];
+        checkStarts.push_back(static_cast<int>(pending.size()));
+        auto third = left + (right - left) / 3, twoThirds = left + (2 * (right - left)) / 3;
+        if(third == left || third == twoThirds){
+            pending.push_back((left + right) / 2);
+        }
+        else{
+            pending.push_back(third);
+            pending.push_back(twoThirds);
+        }
+    }
+    checkStarts.push_back(static_cast<int>(pending.size()));
+}
+
+//Fritsch-Butland weighted harmonic mean of the neighbouring secants, zero at a local extremum so the spline never
+//overshoots the samples, one sided secants at both ends
+float CurveSampler::slopeAt(int trace, size_t k) const{
+    const auto& y = values[static_cast<size_t>(trace)];
+    auto secant = [&](size_t i){
+        return (y[static_cast<size_t>(samples[i + 1])] - y[static_cast<size_t>(samples[i])])
+               / static_cast<float>(samples[i + 1] - samples[i]);
+    };
+
+    if(samples.size() < 2){
+        return 0.f;
+    }
+    if(k == 0){
+        return secant(0);
+    }
+    if(k + 1 == samples.size()){
+        return secant(k - 1);
+    }
+
+    auto d0 = secant(k - 1), d1 = secant(k);
+    if(d0 * d1 <= 0.f){
+        return 0.f;
+    }
+    auto h0 = static_cast<float>(samples[k] - samples[k - 1]);
+    auto h1 = static_cast<float>(samples[k + 1] - samples[k]);
+    auto w0 = 2.f * h1 + h0, w1 = h1 + 2.f * h0;
+    return (w0 + w1) / (w0 / d0 + w1 / d1);
+}
+
+//cubic Hermite between samples[k] and samples[k + 1]
+float CurveSampler::interpolate(int trace, size_t k, float column) const{
+    const auto& y = values[static_cast<size_t>(trace)];
+    auto x0 = static_cast<float>(samples[k]);
+    auto h = static_cast<float>(samples[k + 1] - samples[k]);
+    auto s = (column - x0) / h;
+    auto y0 = y[static_cast<size_t>(samples[k])], y1 = y[static_cast<size_t>(samples[k + 1])];
+    auto m0 = slopeAt(trace, k) * h, m1 = slopeAt(trace, k + 1) * h;
+
+    auto s2 = s * s, s3 = s2 * s;
+    return (2.f * s3 - 3.f * s2 + 1.f) * y0 + (s3 - 2.f * s2 + s) * m0 + (3.f * s2 - 2.f * s3) * y1 + (s3 - s2) * m1;
+}
+
+void CurveSampler::reconstruct(int trace, float* output) const{
+    const auto& y = values[static_cast<size_t>(trace)];
+    for(size_t k = 0; k + 1 < samples.size(); ++k){
+        output[samples[k]] = y[static_cast<size_t>(samples[k])];
+        for(int column = samples[k] + 1; column < samples[k + 1]; ++column){
+            output[column] = interpolate(trace, k, static_cast<float>(column));
+        }
+    }
+    if(! samples.empty()){
+        output[samples.back()] = y[static_cast<size_t>(samples.back())];
+    }
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    CurveSampler.h
+    Adaptive column sampling of smooth curves with monotone cubic reconstruction
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <limits>
+#include <vector>
+
+//picks which pixel columns of a curve are worth evaluating and fills in the rest with a monotone cubic (PCHIP) spline
+//sampling starts from a coarse grid plus dense seed columns around known features, then every interval is checked by
+//evaluating it at a third and two thirds of its width and comparing with what the spline predicted there, intervals
+//that miss by more than the tolerance are split at those points and checked again until they pass or shrink to a
+//single column, where the curve is exact
+//two check points rather than one midpoint keep a curve that happens to cross the spline halfway from slipping through
+//this is a heuristic, not a bound: the error between the check points is only inferred from the error at them, so a
+//feature narrower than their spacing can fall between them and pass unseen, which is why callers seed the columns
+//around every feature they know of
+//Tests/Source/CurveSamplerTests.cpp measures the actual error against every column evaluated for the bands the editor
+//draws, it stays well under a pixel
+//the caller evaluates the columns in getPendingColumns() (in one batch) and hands the values to supply() until isDone()
+struct CurveSampler{
+    static constexpr int MaxTraces = 3;
+
+    //pixelsPerUnit turns a trace's values into pixels for the tolerance check
+    //a non zero period marks a wrapped trace (phase), its samples are unwrapped against their left neighbour
+    //differences below floor are ignored, for values that can never be on screen
+    void setTrace(int trace, float pixelsPerUnit, float period = 0.f, float floor = std::numeric_limits<float>::lowest());
+
+    //starts a new curve over numColumns columns, seeds are extra columns to sample from the start, in any order
+    void begin(int numColumns, int numTraces, const std::vector<int>& seeds);
+
+    //columns whose values supply() expects next, sorted
+    const std::vector<int>& getPendingColumns() const { return pending; }
+    //values[trace][k] belongs to getPendingColumns()[k]
+    void supply(const std::array<const float*, MaxTraces>& values);
+    bool isDone() const { return pending.empty(); }
+
+    //writes one value per column, exact at the sampled columns
+    void reconstruct(int trace, float* output) const;
+
+    int getNumSamples() const { return static_cast<int>(samples.size()); }
+
+    //coarsest spacing of the initial grid and the largest error an accepted check point may have, in pixels
+    //the tolerance holds at the check points only, not everywhere in between
+    static constexpr int MaxSpacing = 16;
+    static constexpr float TolerancePixels = 0.25f;
+
+private:
+    int numColumns = 0, numTraces = 0;
+    std::array<float, MaxTraces> pixelsPerUnit {1.f, 1.f, 1.f}, period {};
+    std::array<float, MaxTraces> floor {std::numeric_limits<float>::lowest(),
+                                        std::numeric_limits<float>::lowest(),
+                                        std::numeric_limits<float>::lowest()};
+
+    //sampled columns in order, with each trace's value stored at its column
+    std::vector<int> samples;
+    std::array<std::vector<float>, MaxTraces> values;
+
+    //columns to evaluate next and, after the first round, the intervals they check by their left sample column,
+    //the check points of checking[j] are pending[checkStarts[j]] up to pending[checkStarts[j + 1]]
+    std::vector<int> pending, checking, checkStarts;
+    //scratch for the next round
+    std::vector<int> nextChecking, merged;
+
+    //PCHIP slope at samples[k] and the spline on the interval starting at samples[k]
+    float slopeAt(int trace, size_t k) const;
+    float interpolate(int trace, size_t k, float column) const;
+    void queueChecks();
+};
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    HalfBandDecimator.cpp
+    Windowed sinc half-band low pass that drops every other sample
+
+  ==============================================================================
+*/
+
+#include "HalfBandDecimator.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+#if JUCE_ARM && defined(__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+namespace{
+    constexpr int NumOddTaps = HalfBandDecimator::NumOddTaps;
+}
+
+//the scalar loop is the tail of every vector build, from the first output the vector loop left
+static void addHalfBandOutputs(const float* even, const float* odd, const float* oddTaps, float centre, float* output,
+                               int m, int numOutputs){
+    for(; m < numOutputs; ++m){
+        auto y = centre * odd[m];
+        for(int j = 0; j < NumOddTaps; ++j){
+            y += oddTaps[j] * (even[m + NumOddTaps - 1 - j] + even[m + NumOddTaps + j]);
+        }
+        output[m] = y;
+    }
+}
+
+static void computeHalfBandOutputsScalar(const float* even, const float* odd, const float* oddTaps, float centre,
+                                         float* output, int numOutputs){
+    addHalfBandOutputs(even, odd, oddTaps, centre, output, 0, numOutputs);
+}
+
+#if JUCE_INTEL
+static void computeHalfBandOutputsSSE2(const float* even, const float* odd, const float* oddTaps, float centre,
+                                       float* output, int numOutputs){
+    int m = 0;
+    for(; m + 4 <= numOutputs; m += 4){
+        auto y = _mm_mul_ps(_mm_set1_ps(centre), _mm_loadu_ps(odd + m));
+        for(int j = 0; j < NumOddTaps; ++j){
+            auto pair = _mm_add_ps(_mm_loadu_ps(even + m + NumOddTaps - 1 - j), _mm_loadu_ps(even + m + NumOddTaps + j));
+            y = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(oddTaps[j]), pair));
+        }
+        _mm_storeu_ps(output + m, y);
+    }
+    addHalfBandOutputs(even, odd, oddTaps, centre, output, m, numOutputs);
+}
+#endif
+
+#if SIMPLEEQ_AVX2
+//eight outputs per step, the tap pairs alternate between two accumulators so consecutive fused multiply-adds do
+//not wait on each other
+SIMPLEEQ_TARGET_AVX2
+static void computeHalfBandOutputsAVX2(const float* even, const float* odd, const float* oddTaps, float centre,
+                                       float* output, int numOutputs){
+    int m = 0;
+    for(; m + 8 <= numOutputs; m += 8){
+        auto y0 = _mm256_mul_ps(_mm256_set1_ps(centre), _mm256_loadu_ps(odd + m));
+        auto y1 = _mm256_setzero_ps();
+        for(int j = 0; j < NumOddTaps; j += 2){
+            auto pair0 = _mm256_add_ps(_mm256_loadu_ps(even + m + NumOddTaps - 1 - j),
+                                       _mm256_loadu_ps(even + m + NumOddTaps + j));
+            auto pair1 = _mm256_add_ps(_mm256_loadu_ps(even + m + NumOddTaps - 2 - j),
+                                       _mm256_loadu_ps(even + m + NumOddTaps + 1 + j));
+            y0 = _mm256_fmadd_ps(_mm256_set1_ps(oddTaps[j]), pair0, y0);
+            y1 = _mm256_fmadd_ps(_mm256_set1_ps(oddTaps[j + 1]), pair1, y1);
+        }
+        _mm256_storeu_ps(output + m, _mm256_add_ps(y0, y1));
+    }
+    addHalfBandOutputs(even, odd, oddTaps, centre, output, m, numOutputs);
+}
+#endif
+
+#if JUCE_ARM && defined(__ARM_NEON)
+static void computeHalfBandOutputsNEON(const float* even, const float* odd, const float* oddTaps, float centre,
+                                       float* output, int numOutputs){
+    int m = 0;
+    for(; m + 4 <= numOutputs; m += 4){
+        auto y = vmulq_n_f32(vld1q_f32(odd + m), centre);
+        for(int j = 0; j < NumOddTaps; ++j){
+            auto pair = vaddq_f32(vld1q_f32(even + m + NumOddTaps - 1 - j), vld1q_f32(even + m + NumOddTaps + j));
+            y = vmlaq_n_f32(y, pair, oddTaps[j]);
+        }
+        vst1q_f32(output + m, y);
+    }
+    addHalfBandOutputs(even, odd, oddTaps, centre, output, m, numOutputs);
+}
+#endif
+
+void computeHalfBandOutputs(const float* even, const float* odd, const float* oddTaps, float centre, float* output,
+                            int numOutputs){
+   #if JUCE_INTEL
+    computeHalfBandOutputsSSE2(even, odd, oddTaps, centre, output, numOutputs);
+   #elif JUCE_ARM && defined(__ARM_NEON)
+    computeHalfBandOutputsNEON(even, odd, oddTaps, centre, output, numOutputs);
+   #else
+    computeHalfBandOutputsScalar(even, odd, oddTaps, centre, output, numOutputs);
+   #endif
+}
+
+HalfBandKernel getHalfBandKernel(IsaLevel isa){
+    switch(isa){
+       #if JUCE_INTEL
+        case IsaLevel::SSE2:
+            return computeHalfBandOutputsSSE2;
+       #endif
+       #if SIMPLEEQ_AVX2
+        case IsaLevel::AVX2:
+            return computeHalfBandOutputsAVX2;
+       #endif
+       #if JUCE_ARM && defined(__ARM_NEON)
+        case IsaLevel::NEON:
+            return computeHalfBandOutputsNEON;
+       #endif
+        default:
+            return computeHalfBandOutputsScalar;
+    }
+}
+
+HalfBandDecimator::HalfBandDecimator(){
+    //sinc at half the input Nyquist shaped by a Blackman window, then scaled for unity gain at DC
+    auto sum = 0.5;
+    std::array<double, NumOddTaps> taps;
+    for(int j = 0; j < NumOddTaps; ++j){
+        auto m = 2 * j + 1;
+        auto sinc = std::sin(juce::MathConstants<double>::halfPi * m) / (juce::MathConstants<double>::pi * m);
+        auto phase = juce::MathConstants<double>::twoPi * (Centre + m) / (Length - 1);
+        auto window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        taps[static_cast<size_t>(j)] = sinc * window;
+        sum += 2.0 * taps[static_cast<size_t>(j)];
+    }
+
+    centreTap = static_cast<float>(0.5 / sum);
+    for(int j = 0; j < NumOddTaps; ++j){
+        oddTaps[static_cast<size_t>(j)] = static_cast<float>(taps[static_cast<size_t>(j)] / sum);
+    }
+}
+
+void HalfBandDecimator::reset(){
+    even.fill(0.f);
+    odd.fill(0.f);
+    numEven = Centre;
+    numOdd = NumOddTaps;
+    nextIsEven = true;
+}
+
+int HalfBandDecimator::process(const float* input, int numSamples, float* output){
+    int numOutputs = 0;
+    int i = 0;
+
+    while(i < numSamples){
+        for(; i < numSamples && numEven < static_cast<int>(even.size()); ++i){
+            if(nextIsEven){
+                even[static_cast<size_t>(numEven++)] = input[i];
+            }
+            else{
+                odd[static_cast<size_t>(numOdd++)] = input[i];
+            }
+            nextIsEven = ! nextIsEven;
+        }
+
+        //every even sample past the history completes an output, so all of them are due
+        //an output is only written after the input at twice its index was read, so in place use is safe
+        auto newOutputs = numEven - Centre;
+        if(newOutputs > 0){
+            kernel(even.data(), odd.data(), oddTaps.data(), centreTap, output + numOutputs, newOutputs);
+            numOutputs += newOutputs;
+
+            std::copy(even.begin() + newOutputs, even.begin() + numEven, even.begin());
+            std::copy(odd.begin() + newOutputs, odd.begin() + numOdd, odd.begin());
+            numEven -= newOutputs;
+            numOdd -= newOutputs;
+        }
+    }
+
+    return numOutputs;
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    HalfBandDecimator.h
+    Windowed sinc half-band low pass that drops every other sample
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "CpuDispatch.h"
+
+#include <array>
+
+//outputs m = 0 .. numOutputs - 1 of the filter from its input split into even and odd samples:
+//    output[m] = centre * odd[m] + sum over j of oddTaps[j] * (even[m + 11 - j] + even[m + 12 + j])
+//even needs numOutputs + 23 samples and odd numOutputs, neighbouring outputs read overlapping runs of the same
+//arrays, so the vector builds compute four or eight outputs at once from unaligned loads
+using HalfBandKernel = void (*)(const float*, const float*, const float*, float, float*, int);
+
+//the SSE2 build on Intel and the NEON build on ARM
+void computeHalfBandOutputs(const float* even, const float* odd, const float* oddTaps, float centre, float* output,
+                            int numOutputs);
+
+//the same built for the given instruction set, only pass levels isIsaSupported() accepts
+HalfBandKernel getHalfBandKernel(IsaLevel isa);
+
+//every even tap of a half-band FIR except the centre one is zero, so each output costs one multiply per odd tap pair
+//passband reaches about 0.19 of the input rate and everything from 0.31 up is at least 70 dB down, so the band below
+//0.7 of the output Nyquist is free of aliases
+struct HalfBandDecimator{
+    HalfBandDecimator();
+
+    void reset();
+
+    //picks the kernel build, call before processing starts
+    void setIsaLevel(IsaLevel isa) { kernel = getHalfBandKernel(isa); }
+
+    //writes one output for every second input and returns how many, output may be the same buffer as input
+    int process(const float* input, int numSamples, float* output);
+
+    //fraction of the output Nyquist that is clean enough to display
+    static constexpr float UsableBandwidth = 0.7f;
+    //taps either side of the centre, the length of the kernels' oddTaps
+    static constexpr int NumOddTaps = 12;
+
+private:
+    static constexpr int Length = 4 * NumOddTaps - 1;
+    static constexpr int Centre = Length / 2;
+    //outputs per kernel call, longer inputs go through in pieces
+    static constexpr int MaxOutputs = 128;
+
+    //taps at offsets 1, 3, 5 ... either side of the centre, the centre tap is close to 0.5
+    std::array<float, NumOddTaps> oddTaps {};
+    float centreTap = 0.5f;
+
+    //input split by parity, each led by the samples older outputs still need: the Centre even samples before the
+    //next output's newest one, and the NumOddTaps odd ones from its centre sample on
+    std::array<float, Centre + MaxOutputs> even {};
+    std::array<float, NumOddTaps + MaxOutputs> odd {};
+    int numEven = Centre;
+    int numOdd = NumOddTaps;
+    //outputs fall on the even input samples, counted from the first sample after a reset
+    bool nextIsEven = true;
+
+    HalfBandKernel kernel { computeHalfBandOutputs };
+};
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    KnobSprites.cpp
+    Pre-rasterized rotary knob body and pointer frames for one size and scale
+
+  ==============================================================================
+*/
+
+#include "KnobSprites.h"
+
+const juce::Colour KnobSprites::BodyColour { 97u, 18u, 167u };
+const juce::Colour KnobSprites::EdgeColour { 255u, 154u, 1u };
+
+KnobSprites::KnobSprites(const Key& k) : key(k){
+    renderBody();
+}
+
+//filled circle and its 1 px border, the border straddles the edge so the image has a one pixel margin
+void KnobSprites::renderBody(){
+    using namespace juce;
+
+    auto margin = static_cast<int>(std::ceil(key.scale));
+    auto size = roundToInt(key.diameter * key.scale) + 2 * margin;
+
+    body.image = Image(Image::ARGB, size, size, true, SoftwareImageType());
+    body.offset = { -margin, -margin };
+
+    Graphics g(body.image);
+    g.addTransform(AffineTransform::scale(key.scale).translated(static_cast<float>(margin), static_cast<float>(margin)));
+
+    auto bounds = Rectangle<float>(0.f, 0.f, static_cast<float>(key.diameter), static_cast<float>(key.diameter));
+    g.setColour(BodyColour);
+    g.fillEllipse(bounds);
+    g.setColour(EdgeColour);
+    g.drawEllipse(bounds, 1.f);
+}
+
+//rounded bar from the rim towards the centre, rotated to the frame's angle and cropped to its own bounds
+void KnobSprites::renderPointer(int index){
+    using namespace juce;
+
+    auto diameter = static_cast<float>(key.diameter);
+    auto centre = Point<float>(diameter * 0.5f, diameter * 0.5f);
+
+    Rectangle<float> r;
+    r.setLeft(centre.getX() - 2);
+    r.setRight(centre.getX() + 2);
+    r.setTop(0.f);
+    r.setBottom(centre.getY() - key.pointerInset);
+
+    Path p;
+    p.addRoundedRectangle(r, 2.f);
+
+    auto angle = jmap(static_cast<float>(index) / (NumFrames - 1), 0.f, 1.f, key.startAngle, key.endAngle);
+    p.applyTransform(AffineTransform::rotation(angle, centre.getX(), centre.getY())
+                     .scaled(key.scale));
+
+    auto area = p.getBounds().expanded(1.f).getSmallestIntegerContainer();
+
+    auto& frame = pointers[static_cast<size_t>(index)];
+    frame.image = Image(Image::ARGB, jmax(1, area.getWidth()), jmax(1, area.getHeight()), true, SoftwareImageType());
+    frame.offset = area.getPosition();
+
+    Graphics g(frame.image);
+    g.setColour(EdgeColour);
+    g.fillPath(p, AffineTransform::translation(static_cast<float>(-area.getX()), static_cast<float>(-area.getY())));
+}
+
+void KnobSprites::drawFrame(juce::Graphics& g, const Frame& frame, juce::Point<float> topLeft) const{
+    //a pure translation once the context's own scale is applied, so the renderer blits instead of resampling
+    g.drawImageTransformed(frame.image,
+                           juce::AffineTransform::translation(frame.offset.toFloat())
+                           .scaled(1.f / key.scale)
+                           .translated(topLeft));
+}
+
+void KnobSprites::draw(juce::Graphics& g, juce::Point<float> topLeft, float sliderPosProportional){
+    auto index = juce::jlimit(0, NumFrames - 1, juce::roundToInt(sliderPosProportional * (NumFrames - 1)));
+    if(! pointers[static_cast<size_t>(index)].image.isValid()){
+        renderPointer(index);
+    }
+
+    drawFrame(g, body, topLeft);
+    drawFrame(g, pointers[static_cast<size_t>(index)], topLeft);
+}
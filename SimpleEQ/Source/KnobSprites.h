@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    KnobSprites.h
+    Pre-rasterized rotary knob body and pointer frames for one size and scale
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+
+//the knob body never changes with the value, so it is rasterized once, the pointer is one of NumFrames frames
+//(the usual filmstrip resolution) rendered the first time its position is shown
+//everything is rasterized at the physical pixel scale it is drawn at, so drawing a knob is two image blits
+//pointer frames are cropped to the rotated pointer, which keeps a full set to a few hundred kB even at 2x
+class KnobSprites{
+public:
+    struct Key{
+        int diameter;
+        float scale;
+        float startAngle, endAngle;
+        //distance the pointer stops short of the centre, leaving room for the value label
+        float pointerInset;
+
+        bool operator==(const Key& other) const{
+            return diameter == other.diameter && scale == other.scale && startAngle == other.startAngle
+                && endAngle == other.endAngle && pointerInset == other.pointerInset;
+        }
+    };
+
+    explicit KnobSprites(const Key& key);
+
+    const Key& getKey() const { return key; }
+
+    //draws the knob with its top left corner at topLeft in the logical coordinates of g
+    void draw(juce::Graphics& g, juce::Point<float> topLeft, float sliderPosProportional);
+
+    static constexpr int NumFrames = 128;
+
+    static const juce::Colour BodyColour;
+    static const juce::Colour EdgeColour;
+
+private:
+    struct Frame{
+        juce::Image image;
+        //physical pixel offset of the image from the knob's top left corner
+        juce::Point<int> offset;
+    };
+
+    Key key;
+    Frame body;
+    std::array<Frame, NumFrames> pointers;
+
+    void renderBody();
+    void renderPointer(int index);
+
+    void drawFrame(juce::Graphics& g, const Frame& frame, juce::Point<float> topLeft) const;
+};
@@ -0,0 +1,258 @@
+/*
+  ==============================================================================
+
+    Metering.cpp
+    Per channel RMS, peak and true peak plus stereo correlation, published without locks
+
+  ==============================================================================
+*/
+
+#include "Metering.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+#if JUCE_ARM && defined(__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+//the scalar loop is the tail of every vector build, from the first sample the vector loop left
+static void addBlockSums(const float* left, const float* right, int i, int numSamples, StereoBlockSums& sums){
+    for(; i < numSamples; ++i){
+        sums.leftSquares += left[i] * left[i];
+        sums.rightSquares += right[i] * right[i];
+        sums.products += left[i] * right[i];
+    }
+}
+
+static StereoBlockSums computeStereoBlockSumsScalar(const float* left, const float* right, int numSamples){
+    StereoBlockSums sums;
+    addBlockSums(left, right, 0, numSamples, sums);
+    return sums;
+}
+
+#if JUCE_INTEL
+static StereoBlockSums computeStereoBlockSumsSSE2(const float* left, const float* right, int numSamples){
+    StereoBlockSums sums;
+    int i = 0;
+    auto ll = _mm_setzero_ps(), rr = _mm_setzero_ps(), lr = _mm_setzero_ps();
+    for(; i + 4 <= numSamples; i += 4){
+        auto l = _mm_loadu_ps(left + i);
+        auto r = _mm_loadu_ps(right + i);
+        ll = _mm_add_ps(ll, _mm_mul_ps(l, l));
+        rr = _mm_add_ps(rr, _mm_mul_ps(r, r));
+        lr = _mm_add_ps(lr, _mm_mul_ps(l, r));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, ll);
+    sums.leftSquares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_store_ps(lanes, rr);
+    sums.rightSquares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_store_ps(lanes, lr);
+    sums.products = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    addBlockSums(left, right, i, numSamples, sums);
+    return sums;
+}
+#endif
+
+#if SIMPLEEQ_AVX2
+//eight samples per step into fused multiply-adds, the two halves are added before the same four lane reduction
+SIMPLEEQ_TARGET_AVX2
+static StereoBlockSums computeStereoBlockSumsAVX2(const float* left, const float* right, int numSamples){
+    StereoBlockSums sums;
+    int i = 0;
+    auto ll = _mm256_setzero_ps(), rr = _mm256_setzero_ps(), lr = _mm256_setzero_ps();
+    for(; i + 8 <= numSamples; i += 8){
+        auto l = _mm256_loadu_ps(left + i);
+        auto r = _mm256_loadu_ps(right + i);
+        ll = _mm256_fmadd_ps(l, l, ll);
+        rr = _mm256_fmadd_ps(r, r, rr);
+        lr = _mm256_fmadd_ps(l, r, lr);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(_mm256_castps256_ps128(ll), _mm256_extractf128_ps(ll, 1)));
+    sums.leftSquares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_store_ps(lanes, _mm_add_ps(_mm256_castps256_ps128(rr), _mm256_extractf128_ps(rr, 1)));
+    sums.rightSquares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_store_ps(lanes, _mm_add_ps(_mm256_castps256_ps128(lr), _mm256_extractf128_ps(lr, 1)));
+    sums.products = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    addBlockSums(left, right, i, numSamples, sums);
+    return sums;
+}
+#endif
+
+#if JUCE_ARM && defined(__ARM_NEON)
+static StereoBlockSums computeStereoBlockSumsNEON(const float* left, const float* right, int numSamples){
+    StereoBlockSums sums;
+    int i = 0;
+    auto ll = vdupq_n_f32(0.f), rr = vdupq_n_f32(0.f), lr = vdupq_n_f32(0.f);
+    for(; i + 4 <= numSamples; i += 4){
+        auto l = vld1q_f32(left + i);
+        auto r = vld1q_f32(right + i);
+        ll = vmlaq_f32(ll, l, l);
+        rr = vmlaq_f32(rr, r, r);
+        lr = vmlaq_f32(lr, l, r);
+    }
+    auto horizontal = [](float32x4_t v){
+        auto pair = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(pair, pair), 0);
+    };
+    sums.leftSquares = horizontal(ll);
+    sums.rightSquares = horizontal(rr);
+    sums.products = horizontal(lr);
+
+    addBlockSums(left, right, i, numSamples, sums);
+    return sums;
+}
+#endif
+
+StereoBlockSums computeStereoBlockSums(const float* left, const float* right, int numSamples){
+   #if JUCE_INTEL
+    return computeStereoBlockSumsSSE2(left, right, numSamples);
+   #elif JUCE_ARM && defined(__ARM_NEON)
+    return computeStereoBlockSumsNEON(left, right, numSamples);
+   #else
+    return computeStereoBlockSumsScalar(left, right, numSamples);
+   #endif
+}
+
+StereoBlockSumsKernel getStereoBlockSumsKernel(IsaLevel isa){
+    switch(isa){
+       #if JUCE_INTEL
+        case IsaLevel::SSE2:
+            return computeStereoBlockSumsSSE2;
+       #endif
+       #if SIMPLEEQ_AVX2
+        case IsaLevel::AVX2:
+            return computeStereoBlockSumsAVX2;
+       #endif
+       #if JUCE_ARM && defined(__ARM_NEON)
+        case IsaLevel::NEON:
+            return computeStereoBlockSumsNEON;
+       #endif
+        default:
+            return computeStereoBlockSumsScalar;
+    }
+}
+
+void MeterPublisher::publish(const MeterSnapshot& snapshot){
+    float raw[NumValues];
+    std::memcpy(raw, &snapshot, sizeof(raw));
+
+    auto seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for(int i = 0; i < NumValues; ++i){
+        values[static_cast<size_t>(i)].store(raw[i], std::memory_order_relaxed);
+    }
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+MeterSnapshot MeterPublisher::read() const{
+    float raw[NumValues];
+    for(;;){
+        auto before = sequence.load(std::memory_order_acquire);
+        if(before & 1){
+            continue;
+        }
+        for(int i = 0; i < NumValues; ++i){
+            raw[i] = values[static_cast<size_t>(i)].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(sequence.load(std::memory_order_relaxed) == before){
+            break;
+        }
+    }
+
+    MeterSnapshot snapshot;
+    std::memcpy(&snapshot, raw, sizeof(raw));
+    return snapshot;
+}
+
+void StereoMeter::prepare(double newSampleRate, int maximumBlockSize){
+    sampleRate = newSampleRate;
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+
+    //factor 2 is two half-band stages, 4x
+    oversampler = std::make_unique<juce::dsp::Oversampling<float>>(2, 2,
+                                                                   juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
+                                                                   false);
+    oversampler->initProcessing(static_cast<size_t>(maxBlockSize));
+    reset();
+}
+
+void StereoMeter::reset(){
+    if(oversampler != nullptr){
+        oversampler->reset();
+    }
+    meanLeft = meanRight = meanProduct = 0.0;
+    heldPeak = {};
+    heldTruePeak = {};
+    publisher.publish({});
+}
+
+void StereoMeter::measureTruePeak(const float* left, const float* right, int numSamples, std::array<float, 2>& result){
+    result = {};
+    if(oversampler == nullptr){
+        return;
+    }
+
+    //the oversampler is sized for the prepared block size, longer host blocks go through in pieces
+    for(int start = 0; start < numSamples; start += maxBlockSize){
+        auto n = juce::jmin(maxBlockSize, numSamples - start);
+        const float* channels[] = {left + start, right + start};
+        juce::dsp::AudioBlock<const float> block(channels, 2, static_cast<size_t>(n));
+
+        auto upsampled = oversampler->processSamplesUp(block);
+        for(size_t ch = 0; ch < 2; ++ch){
+            auto range = juce::FloatVectorOperations::findMinAndMax(upsampled.getChannelPointer(ch),
+                                                                    static_cast<int>(upsampled.getNumSamples()));
+            result[ch] = juce::jmax(result[ch], -range.getStart(), range.getEnd());
+        }
+    }
+}
+
+void StereoMeter::process(const float* left, const float* right, int numSamples){
+    if(numSamples <= 0){
+        return;
+    }
+
+    auto sums = blockSums(left, right, numSamples);
+
+    //one pole integration per block, so the time constant does not depend on the host block size
+    auto blockSeconds = numSamples / sampleRate;
+    auto keep = std::exp(-blockSeconds / 0.3);
+    meanLeft = meanLeft * keep + (1.0 - keep) * sums.leftSquares / numSamples;
+    meanRight = meanRight * keep + (1.0 - keep) * sums.rightSquares / numSamples;
+    meanProduct = meanProduct * keep + (1.0 - keep) * sums.products / numSamples;
+
+    std::array<float, 2> blockPeak;
+    const float* channels[] = {left, right};
+    for(size_t ch = 0; ch < 2; ++ch){
+        auto range = juce::FloatVectorOperations::findMinAndMax(channels[ch], numSamples);
+        blockPeak[ch] = juce::jmax(-range.getStart(), range.getEnd());
+    }
+
+    std::array<float, 2> blockTruePeak;
+    measureTruePeak(left, right, numSamples, blockTruePeak);
+
+    //20 dB per second fall back
+    auto fall = static_cast<float>(std::pow(0.1, blockSeconds));
+
+    MeterSnapshot snapshot;
+    for(size_t ch = 0; ch < 2; ++ch){
+        heldPeak[ch] = juce::jmax(blockPeak[ch], heldPeak[ch] * fall);
+        heldTruePeak[ch] = juce::jmax(blockTruePeak[ch], blockPeak[ch], heldTruePeak[ch] * fall);
+        snapshot.peak[ch] = heldPeak[ch];
+        snapshot.truePeak[ch] = heldTruePeak[ch];
+    }
+    snapshot.rms = {static_cast<float>(std::sqrt(meanLeft)), static_cast<float>(std::sqrt(meanRight))};
+
+    //silence has no defined correlation, it reads as unrelated
+    auto energy = std::sqrt(meanLeft * meanRight);
+    snapshot.correlation = energy > 1.0e-10 ? static_cast<float>(juce::jlimit(-1.0, 1.0, meanProduct / energy)) : 0.f;
+
+    publisher.publish(snapshot);
+}
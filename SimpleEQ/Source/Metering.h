@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    Metering.h
+    Per channel RMS, peak and true peak plus stereo correlation, published without locks
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "CpuDispatch.h"
+
+#include <array>
+#include <atomic>
+
+//levels are linear gain, correlation runs from -1 (out of phase) through 0 (unrelated) to +1 (mono)
+struct MeterSnapshot{
+    std::array<float, 2> rms {};
+    std::array<float, 2> peak {};
+    std::array<float, 2> truePeak {};
+    float correlation = 0.f;
+};
+
+//sums over one block of a stereo pair, filled by one pass of vector multiply-adds
+struct StereoBlockSums{
+    float leftSquares = 0.f;
+    float rightSquares = 0.f;
+    float products = 0.f;
+};
+StereoBlockSums computeStereoBlockSums(const float* left, const float* right, int numSamples);
+
+using StereoBlockSumsKernel = StereoBlockSums (*)(const float*, const float*, int);
+
+//computeStereoBlockSums built for the given instruction set, computeStereoBlockSums itself is the SSE2 build on Intel
+//and the NEON build on ARM, the levels those targets always have
+StereoBlockSumsKernel getStereoBlockSumsKernel(IsaLevel isa);
+
+//single writer sequence lock: the writer makes the counter odd, stores the values and makes it even again, readers
+//retry until they saw the same even count before and after copying, so they always get one whole snapshot and the
+//audio thread never waits
+class MeterPublisher{
+public:
+    void publish(const MeterSnapshot& snapshot);
+    MeterSnapshot read() const;
+
+private:
+    static constexpr int NumValues = sizeof(MeterSnapshot) / sizeof(float);
+    static_assert(sizeof(MeterSnapshot) == NumValues * sizeof(float), "MeterSnapshot must only hold floats");
+
+    std::atomic<juce::uint32> sequence { 0 };
+    std::array<std::atomic<float>, NumValues> values {};
+};
+
+//runs on the audio thread over the post EQ signal
+//RMS and correlation integrate with a 300 ms time constant per block, peaks hold the block maximum and fall back
+//at 20 dB per second, true peak is the sample peak of a 4x polyphase oversampled copy
+struct StereoMeter{
+    //allocates the oversampler, call from prepareToPlay
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+    //picks the block sums kernel, call from prepareToPlay with the processor's level
+    void setIsaLevel(IsaLevel isa) { blockSums = getStereoBlockSumsKernel(isa); }
+
+    void process(const float* left, const float* right, int numSamples);
+
+    //lock free, safe from any thread
+    MeterSnapshot getSnapshot() const { return publisher.read(); }
+
+private:
+    //2 channel, 4x half-band polyphase IIR oversampler, private to the meter as its filters keep state between
+    //blocks, an oversampled processing mode would hand the meter its already upsampled block instead
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+    int maxBlockSize = 0;
+    double sampleRate = 44100.0;
+    StereoBlockSumsKernel blockSums { computeStereoBlockSums };
+
+    //running mean squares and mean product
+    double meanLeft = 0.0, meanRight = 0.0, meanProduct = 0.0;
+    std::array<float, 2> heldPeak {}, heldTruePeak {};
+
+    MeterPublisher publisher;
+
+    void measureTruePeak(const float* left, const float* right, int numSamples, std::array<float, 2>& result);
+};
@@ -0,0 +1,236 @@
+/*
+  ==============================================================================
+
+    PlotBackground.cpp
+    Grid and labels behind the response curve, rendered and cached off the message thread
+
+  ==============================================================================
+*/
+
+#include "PlotBackground.h"
+
+//draws plot graph of the response curve component
+void drawPlotBackground(juce::Graphics& g, const PlotBackgroundKey& key){
+    using namespace juce;
+    
+    g.fillAll(Colours::black);
+    
+    //array of frequencies for drawing plot lines in range 20 Hz - 20 kHz
+    Array<float> freqs{
+        20, 50, 100,
+        200, 500, 1000,
+        2000, 5000, 10000,
+        20000
+    };
+    
+    auto renderArea = key.analysisArea;
+    auto left = renderArea.getX();
+    auto right = renderArea.getRight();
+    auto top = renderArea.getY();
+    auto bottom = renderArea.getBottom();
+    auto width = renderArea.getWidth();
+    
+    //stores x position for each frequency label within nornalized range to be within bounds of component
+    Array<float> xPos;
+    for(auto f : freqs){
+        auto normX = mapFromLog10(f, 20.f, 20000.f);
+        xPos.add(left + width * normX);
+    }
+    
+    //plots the normalized values
+    g.setColour(Colours::dimgrey);
+    for(auto xs : xPos){
+        //normalizing x value to allow each line to be drawn within the bounds of the response curve component
+        
+        g.drawVerticalLine(xs, top, bottom);
+    }
+    
+    //array of gain units for drawing horizontal plot lines
+    Array<float> gain{
+        -24, -12, 0, 12, 24
+    };
+    
+    //mapping each gain line from gain units to a normalized range between the top and bottom of the component
+    for(auto gDb : gain){
+        auto y = jmap(gDb, -24.f, 24.f, float(bottom), float(top));
+        g.setColour(gDb == 0.f ? Colour(0u, 172u, 1u) : Colours::darkgrey);
+        
+        g.drawHorizontalLine(y, left, right);
+    }
+    
+//    g.drawRect(getAnalysisArea());
+    
+    g.setColour(Colours::lightgrey);
+    const int fontHeight = 10;
+    g.setFont(fontHeight);
+    
+    //drawing labels for each frequency value
+    for(int i = 0; i < freqs.size(); ++i){
+        auto f = freqs[i];
+        auto xs = xPos[i];
+        
+        bool addK = false;
+        String str;
+        if(f > 999.f){
+            addK = true;
+            f /= 1000.f;
+        }
+        
+        str << f;
+        if(addK){
+            str << "k";
+        }
+        str << "Hz";
+        
+        auto textWidth = g.getCurrentFont().getStringWidth(str);
+        
+        Rectangle<int> r;
+        r.setSize(textWidth, fontHeight);
+        r.setCentre(xs, 0);
+        r.setY(1);
+        g.drawFittedText(str, r, juce::Justification::centred, 1);
+    }
+    
+    //drawing labels for each gain value
+    for(auto gDb : gain){
+        auto y = jmap(gDb, -24.f, 24.f, float(bottom), float(top));
+        
+        String str;
+        if(gDb > 0){
+            str << "+";
+        }
+        str << gDb;
+        
+        auto textWidth = g.getCurrentFont().getStringWidth(str);
+        
+        //setting bounding box for each label
+        Rectangle<int> r;
+        r.setSize(textWidth, fontHeight);
+        r.setX(key.width - textWidth);
+        r.setCentre(r.getCentreX(), y);
+        
+        g.setColour(gDb == 0.f ? Colour(0u, 172u, 1u) : Colours::lightgrey);
+        
+        g.drawFittedText(str, r, juce::Justification::centred, 1);
+        
+        //setting values for spectrum analyzer
+        str.clear();
+        str << (gDb - 24.f);
+        
+        //drawing label within fitted, positioned rectangle
+        r.setX(1);
+        textWidth = g.getCurrentFont().getStringWidth(str);
+        r.setSize(textWidth, fontHeight);
+        g.setColour(Colours::lightgrey);
+        g.drawFittedText(str, r, juce::Justification::centred, 1);
+    }
+}
+
+
+PlotBackgroundCache::PlotBackgroundCache() : juce::Thread("Plot Background"){
+}
+
+PlotBackgroundCache::~PlotBackgroundCache(){
+    stopThread(1000);
+}
+
+bool PlotBackgroundCache::setKey(const PlotBackgroundKey& key){
+    if(key == wanted){
+        return false;
+    }
+    wanted = key;
+    
+    for(auto& entry : entries){
+        if(entry.key == key){
+            image = entry.image;
+            return true;
+        }
+    }
+    
+    {
+        const juce::ScopedLock sl(lock);
+        pendingKey = key;
+        pending = true;
+        immediate = ! image.isValid();
+        requestedMs = juce::Time::getMillisecondCounterHiRes();
+    }
+    notify();
+    return false;
+}
+
+bool PlotBackgroundCache::pullLatest(){
+    Entry entry;
+    {
+        const juce::ScopedLock sl(lock);
+        if(! hasFinished){
+            return false;
+        }
+        entry = std::move(finished);
+        hasFinished = false;
+    }
+    
+    auto shown = entry.key == wanted;
+    if(shown){
+        image = entry.image;
+    }
+    store(std::move(entry));
+    return shown;
+}
+
+//replaces an entry for the same key, otherwise drops the oldest once MaxImages are kept
+void PlotBackgroundCache::store(Entry entry){
+    for(auto& existing : entries){
+        if(existing.key == entry.key){
+            existing = std::move(entry);
+            return;
+        }
+    }
+    if(entries.size() == MaxImages){
+        entries.erase(entries.begin());
+    }
+    entries.push_back(std::move(entry));
+}
+
+void PlotBackgroundCache::run(){
+    while(! threadShouldExit()){
+        PlotBackgroundKey key;
+        auto render = false;
+        auto waitMs = -1;
+        {
+            const juce::ScopedLock sl(lock);
+            if(pending){
+                //each new request during a live resize pushes the render back, only the size the window settles
+                //on is rendered
+                auto remaining = requestedMs + DebounceMs - juce::Time::getMillisecondCounterHiRes();
+                if(immediate || remaining <= 0.0){
+                    key = pendingKey;
+                    pending = false;
+                    render = true;
+                }
+                else{
+                    waitMs = juce::jmax(1, juce::roundToInt(remaining));
+                }
+            }
+        }
+        
+        if(! render || key.width <= 0 || key.height <= 0){
+            wait(waitMs);
+            continue;
+        }
+        
+        //software image so the pixels are drawn here and not deferred to a native context on the message thread
+        juce::Image rendered(juce::Image::RGB,
+                             juce::jmax(1, juce::roundToInt(key.width * key.scale)),
+                             juce::jmax(1, juce::roundToInt(key.height * key.scale)),
+                             true, juce::SoftwareImageType());
+        {
+            juce::Graphics g(rendered);
+            g.addTransform(juce::AffineTransform::scale(key.scale));
+            drawPlotBackground(g, key);
+        }
+        
+        const juce::ScopedLock sl(lock);
+        finished = { key, rendered };
+        hasFinished = true;
+    }
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    PlotBackground.h
+    Grid and labels behind the response curve, rendered and cached off the message thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+//what a background image is rendered for, the plot area follows from the size but is passed along so the worker
+//never has to call back into the component
+struct PlotBackgroundKey{
+    int width { 0 }, height { 0 };
+    //physical pixels per logical pixel of the display the component is on
+    float scale { 1.f };
+    juce::Rectangle<int> analysisArea;
+
+    bool operator==(const PlotBackgroundKey& other) const{
+        return width == other.width && height == other.height && scale == other.scale
+            && analysisArea == other.analysisArea;
+    }
+    bool operator!=(const PlotBackgroundKey& other) const { return ! (*this == other); }
+};
+
+//draws the frequency and gain grid with their labels in logical coordinates
+void drawPlotBackground(juce::Graphics& g, const PlotBackgroundKey& key);
+
+//keeps the last few backgrounds keyed by size and scale, so going back to a size (or display) already seen swaps
+//the image in immediately
+//anything else is rendered by this thread into a software image at the physical resolution: the first request
+//right away, requests during a live resize only once no new one has arrived for DebounceMs
+//until it is ready the component keeps stretching the image it had, which is only briefly blurry
+class PlotBackgroundCache : public juce::Thread{
+public:
+    static constexpr double DebounceMs = 100.0;
+    static constexpr size_t MaxImages = 4;
+
+    PlotBackgroundCache();
+    ~PlotBackgroundCache() override;
+
+    //message thread: the background now wanted, returns true if a cached image was switched to right away
+    bool setKey(const PlotBackgroundKey& key);
+
+    //message thread: takes a finished render, returns true if it replaced the image being shown
+    bool pullLatest();
+
+    //image for the wanted key, or the last one shown while that is rendered, invalid before the first render
+    const juce::Image& getImage() const { return image; }
+
+    void run() override;
+
+private:
+    struct Entry{
+        PlotBackgroundKey key;
+        juce::Image image;
+    };
+
+    //message thread only
+    std::vector<Entry> entries;
+    PlotBackgroundKey wanted;
+    juce::Image image;
+
+    //hand over between the message thread and the worker
+    juce::CriticalSection lock;
+    PlotBackgroundKey pendingKey;
+    bool pending { false };
+    //no image to stretch yet, skip the debounce
+    bool immediate { false };
+    double requestedMs { 0.0 };
+    Entry finished;
+    bool hasFinished { false };
+
+    void store(Entry entry);
+
+    JUCE_DECLARE_NON_COPYABLE(PlotBackgroundCache)
+};
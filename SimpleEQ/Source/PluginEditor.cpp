@@ -20,60 +20,42 @@ void LookAndFeel::drawRotarySlider(juce::Graphics & g,
     using namespace juce;
     
     //rectangular bounds of rotary slider
-    auto bounds = Rectangle<float>(x, y, width, height);
+    auto bounds = Rectangle<int>(x, y, width, height);
     
-    //draws the circle representing each slider
-    g.setColour(Colour(97u, 18u, 167u));
-    g.fillEllipse(bounds);
+    //RotarySliderWithLabels draws through drawKnob and its own label directly, this path is only taken by other
+    //sliders using this look and feel, which get the same knob with the pointer stopping short of a label
+    auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider);
+    auto textHeight = rswl != nullptr ? rswl->getTextHeight() : 14;
     
-    //draws a border around each slider
-    g.setColour(Colour(255u, 154u, 1u));
-    g.drawEllipse(bounds, 1.f);
+    drawKnob(g, bounds, sliderPosProportional, rotaryStartAngle, rotaryEndAngle, textHeight * 1.5f);
     
-    //the juce::Slider object must be cast to a RotarySliderWithLabels to use the getTextHeight and getDisplayString methods
-    if(auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider)){
-        auto center = bounds.getCentre();
-        
-        Path p;
-        
-        //sets up a rectangle which will represent where the slider's level is at
-        Rectangle<float> r;
-        r.setLeft(center.getX()-2);
-        r.setRight(center.getX()+2);
-        r.setTop(bounds.getY());
-        r.setBottom(center.getY()-rswl->getTextHeight() * 1.5);
-        
-        p.addRoundedRectangle(r, 2.f);
-        
-        //rotating the rectangle to the correct angle
-        jassert(rotaryStartAngle < rotaryEndAngle);
-        
-        //mapping normalized rotary angle to be between rotary start and end angles
-        auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
-        
-        //rotate Path object around the center based on current position of the slider
-        p.applyTransform(AffineTransform().rotated(sliderAngRad, center.getX(), center.getY()));
-        
-        g.fillPath(p);
-        
-        //draws the value of each parameter
-        g.setFont(rswl->getTextHeight());
-        auto text = rswl->getDisplayString();
-        auto strWidth = g.getCurrentFont().getStringWidth(text);
-        
-        r.setSize(strWidth + 4, rswl->getTextHeight() + 2);
-        r.setCentre(center);
-        
-        g.setColour(Colours::black);
-        g.fillRect(r);
-        
-        g.setColour(Colours::white);
-        g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
+    if(rswl != nullptr){
+        rswl->drawValueLabel(g, bounds.toFloat().getCentre());
+    }
+}
+
+void LookAndFeel::drawKnob(juce::Graphics& g, juce::Rectangle<int> bounds, float sliderPosProportional,
+                           float rotaryStartAngle, float rotaryEndAngle, float pointerInset){
+    //rotating the pointer only works when the start angle comes first
+    jassert(rotaryStartAngle < rotaryEndAngle);
+    
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    auto& sprites = getSprites({ bounds.getWidth(), scale, rotaryStartAngle, rotaryEndAngle, pointerInset });
+    sprites.draw(g, bounds.getTopLeft().toFloat(), sliderPosProportional);
+}
+
+KnobSprites& LookAndFeel::getSprites(const KnobSprites::Key& key){
+    for(auto& sprites : spriteSets){
+        if(sprites->getKey() == key){
+            return *sprites;
+        }
     }
     
-    
-    
-    
+    if(spriteSets.size() == MaxSpriteSets){
+        spriteSets.erase(spriteSets.begin());
+    }
+    spriteSets.push_back(std::make_unique<KnobSprites>(key));
+    return *spriteSets.back();
 }
 
 
@@ -94,21 +76,40 @@ void RotarySliderWithLabels::paint(juce::Graphics &g){
 //    g.setColour(Colours::yellow);
 //    g.drawRect(sliderBounds);
 
-    //call to drawRotarySlider override in LookAndFeel struct
-    getLookAndFeel().drawRotarySlider(g,
-                                      sliderBounds.getX(), sliderBounds.getY(), sliderBounds.getWidth(),
-                                      sliderBounds.getHeight(),
-                                      //maps sliders current value from getValue() from its range to a normalized range
-                                      //between 0 and 1
-                                      jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0),
-                                      startAng, endAng, *this);
+    //knob sprites and the value label are drawn directly, skipping the look and feel's dynamic_cast
+    lnf->drawKnob(g, sliderBounds,
+                  //maps sliders current value from getValue() from its range to a normalized range
+                  //between 0 and 1
+                  static_cast<float>(jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0)),
+                  startAng, endAng, getTextHeight() * 1.5f);
+    drawValueLabel(g, sliderBounds.toFloat().getCentre());
     
     //drawing start and end labels for each parameter
+    if(! rangeLabelsValid){
+        layoutRangeLabels();
+    }
+    g.setColour(Colour(0u, 172u, 1u));
+    rangeLabels.draw(g);
+}
+
+void RotarySliderWithLabels::resized(){
+    juce::Slider::resized();
+    rangeLabelsValid = false;
+}
+
+//positions the start and end labels slightly outside the knob at the angle of their normalized position
+void RotarySliderWithLabels::layoutRangeLabels(){
+    using namespace juce;
+    
+    auto startAng = degreesToRadians(180.f + 45.f);
+    auto endAng = degreesToRadians(180.f - 45.f) +  MathConstants<float>::twoPi;
+    
+    auto sliderBounds = getSliderBounds();
     auto center = sliderBounds.toFloat().getCentre();
     auto radius = sliderBounds.getWidth() * 0.5f;
     
-    g.setColour(Colour(0u, 172u, 1u));
-    g.setFont(getTextHeight());
+    Font font(static_cast<float>(getTextHeight()));
+    rangeLabels.clear();
     
     auto numChoices = labels.size();
     for (int i = 0; i < numChoices; ++i){
@@ -123,14 +124,43 @@ void RotarySliderWithLabels::paint(juce::Graphics &g){
         
         Rectangle<float> r;
         auto str = labels[i].label;
-        r.setSize(g.getCurrentFont().getStringWidth(str), getTextHeight());
+        r.setSize(font.getStringWidthFloat(str), getTextHeight());
         r.setCentre(c);
         r.setY(r.getY() + getTextHeight());
         
-        g.drawFittedText(str, r.toNearestInt(), juce::Justification::centred, 1);
-        
+        rangeLabels.addFittedText(font, str, r.getX(), r.getY(), r.getWidth(), r.getHeight(),
+                                  Justification::centred, 1);
     }
     
+    rangeLabelsValid = true;
+}
+
+//draws the value of each parameter on a black box over the knob's centre
+void RotarySliderWithLabels::drawValueLabel(juce::Graphics& g, juce::Point<float> centre){
+    using namespace juce;
+    
+    //the display string and its glyph positions only change with the value, dragging rebuilds them once per
+    //distinct value and every other repaint reuses them
+    auto value = getValue();
+    if(value != valueLabel.value){
+        Font font(static_cast<float>(getTextHeight()));
+        auto text = getDisplayString();
+        
+        valueLabel.box.setSize(font.getStringWidthFloat(text) + 4, getTextHeight() + 2);
+        valueLabel.box.setCentre(0.f, 0.f);
+        
+        valueLabel.glyphs.clear();
+        valueLabel.glyphs.addFittedText(font, text, valueLabel.box.getX(), valueLabel.box.getY(),
+                                        valueLabel.box.getWidth(), valueLabel.box.getHeight(),
+                                        Justification::centred, 1);
+        valueLabel.value = value;
+    }
+    
+    g.setColour(Colours::black);
+    g.fillRect(valueLabel.box + centre);
+    
+    g.setColour(Colours::white);
+    valueLabel.glyphs.draw(g, AffineTransform::translation(centre));
 }
 
 //sets the bounds of each slider to be a square positioned at the top of each component's bounds
@@ -187,235 +217,148 @@ juce::String RotarySliderWithLabels::getDisplayString() const{
 //==============================================================================
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor &p) :
 audioProcessor(p),
-leftChanelFifo(&audioProcessor.leftChannelFifo)
+curveWorker(audioProcessor),
+analyzer(audioProcessor)
 {
-    //getting parameters and making the editor a listener to allow it to update the responseCurve on param changes
-    const auto& params = audioProcessor.getParameters();
-    for(auto param: params){
-        param->addListener(this);
-    }
-    
-    //assures response curve monoChain values are set correctly upon loading the GUIs
-    updateChain();
-    
-    //starting timer with 60 Hz refresh rate
-    //parameterValueChanged function from Listener class will set an atomic flag which will be checked by timerCallback
-    //to trigger a repaint
-    startTimerHz(60);
-
+    //the worker starts with an update pending, so the curve is built as soon as the plot area is known
+    curveVersion = audioProcessor.getCoefficientVersion();
+    curveSettings = getStereoSettings(audioProcessor.apvts);
+    curveWorker.startThread();
+    backgroundCache.startThread();
+    
+    //the processor only captures and keeps FIFO memory while an analyzer is subscribed
+    audioProcessor.addAnalyzerSubscriber();
+    analyzer.setSampleRate(audioProcessor.getSampleRate());
+    analyzer.setIsaLevel(audioProcessor.getIsaLevel());
+    traceRaster.setIsaLevel(audioProcessor.getIsaLevel());
+    analyzer.startThread();
 }
 
 ResponseCurveComponent::~ResponseCurveComponent(){
-    const auto& params = audioProcessor.getParameters();
-    for(auto param: params){
-        param->removeListener(this);
-    }
+    curveWorker.stopThread(1000);
+    //the analyzer thread reads the FIFO, so it has to stop before the memory can go
+    analyzer.stopThread(1000);
+    audioProcessor.removeAnalyzerSubscriber();
 }
 
 //draws response curve component including response curve background plot
 void ResponseCurveComponent::paint (juce::Graphics& g)
 {
     using namespace juce;
+    ScopedPaint scopedPaint(*this);
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (Colours::black);
     
-    //draws static response curve background image
-    g.drawImage(background, getLocalBounds().toFloat());
+    //the display scale is only known here, a new one asks for a background at the new resolution
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if(scale != displayScale){
+        displayScale = scale;
+        backgroundCache.setKey({ getWidth(), getHeight(), displayScale, getAnalysisArea() });
+    }
+    
+    //draws static response curve background image, stretched from the previous size while a new one is rendered
+    const auto& background = backgroundCache.getImage();
+    if(background.isValid()){
+        g.drawImage(background, getLocalBounds().toFloat());
+    }
 
     //returns resized bounds for rendering response curve component within bounds of plot graph
     auto responseArea = getAnalysisArea();
     
-    auto w = responseArea.getWidth();
-    
-    auto& lowCut = monoChain.get<ChainPositions::LowCut>();
-    auto& highCut = monoChain.get<ChainPositions::HighCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
+    //traces go through the column rasterizer when it has a layer, strokePath is the fallback
+    //the rasterizer only works on the columns inside the region being repainted
+    auto rasterTraces = traceRaster.begin(responseArea, g.getClipBounds(), scale);
     
-    auto sampleRate = audioProcessor.getSampleRate();
-    
-    std::vector<double> magnitudes;
+    auto w = responseArea.getWidth();
     
-    magnitudes.resize(w);
+    const double outputMin = responseArea.getBottom();
+    const double outputMax = responseArea.getY();
     
-    for(int i = 0; i < w; ++i){
-        //expressed in gain units which are multiplicative rather than additive
-        double mag = 1.f;
-        
-        //mapping normalized magnitude to its frequency within human hearing range 20 Hz to 20000 Hz
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-        
-        //checking if a chain is bypassed and then multiplying the curr magnitude by the magnitude at the given frequency
-        //in the given chain
-        if(! monoChain.isBypassed<ChainPositions::Peak>()){
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        
-        if(! lowCut.isBypassed<0>()){
-            mag *= lowCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if(! lowCut.isBypassed<1>()){
-            mag *= lowCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        if(! lowCut.isBypassed<2>()){
-            mag *= lowCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    //latest analyzer frame, already reduced to one level per pixel column by the analyzer thread
+    //levels are drawn against the -48 dB to 0 dB scale on the left of the plot
+    auto mapLevel = [outputMin, outputMax](float level){
+        return jmap(double(level), double(SpectrumAnalyzer::MinDecibels), 0.0, outputMin, outputMax);
+    };
+    auto drawTrace = [&](AnalyzerTap tap, AnalyzerTrace trace, Colour colour){
+        const auto& analyzerLevels = analyzer.getLatest().levels[tap][trace];
+        if(static_cast<int>(analyzerLevels.size()) != w){
+            return;
         }
-        if(! lowCut.isBypassed<3>()){
-            mag *= lowCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        if(rasterTraces){
+            analyzerY.resize(analyzerLevels.size());
+            for(size_t i = 0; i < analyzerLevels.size(); ++i){
+                analyzerY[i] = static_cast<float>(mapLevel(analyzerLevels[i]));
+            }
+            traceRaster.drawPolyline(analyzerY.data(), 0, w, 1.f, colour);
+            return;
         }
-        
-        if(! highCut.isBypassed<0>()){
-            mag *= highCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        Path analyzerPath;
+        analyzerPath.startNewSubPath(responseArea.getX(), mapLevel(analyzerLevels.front()));
+        for(int i = 1; i < w; ++i){
+            analyzerPath.lineTo(responseArea.getX() + i, mapLevel(analyzerLevels[static_cast<size_t>(i)]));
         }
-        if(! highCut.isBypassed<1>()){
-            mag *= highCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        g.setColour(colour);
+        g.strokePath(analyzerPath, PathStrokeType(1.f));
+    };
+    
+    //the channels view setting picks left/right, mid/side or all four, pre EQ adds the input underneath in the same
+    //colours at lower opacity
+    for(auto tap : {Tap_Pre, Tap_Post}){
+        if(tap == Tap_Pre && ! showPreEQ){
+            continue;
         }
-        if(! highCut.isBypassed<2>()){
-            mag *= highCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        auto alpha = tap == Tap_Pre ? 0.35f : 1.f;
+        if(analyzerChannels != 1){
+            drawTrace(tap, Trace_Left, Colours::skyblue.withAlpha(alpha));
+            drawTrace(tap, Trace_Right, Colours::lightgreen.withAlpha(alpha));
         }
-        if(! highCut.isBypassed<3>()){
-            mag *= highCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        if(analyzerChannels != 0){
+            drawTrace(tap, Trace_Mid, Colours::plum.withAlpha(alpha));
+            drawTrace(tap, Trace_Side, Colours::lightcoral.withAlpha(alpha));
         }
-        //converting gain into decibels for mapping the response curve within a dB range
-        magnitudes[i] = Decibels::gainToDecibels(mag);
-    }
-    
-    Path responseCurve;
-    
-    const double outputMin = responseArea.getBottom();
-    const double outputMax = responseArea.getY();
-    //maps each dB unit to within the range we specified
-    auto map = [outputMin, outputMax](double input){
-        return jmap(input, -24.0, 24.0, outputMin, outputMax);
-    };
-    
-    responseCurve.startNewSubPath(responseArea.getX(), map(magnitudes.front()));
-    for(size_t i = 1; i < magnitudes.size(); ++i){
-        responseCurve.lineTo(responseArea.getX() + i, map(magnitudes[i]));
     }
     
     g.setColour(Colours::orange);
     g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
     
-    g.setColour(Colours::white);
-    g.strokePath(responseCurve, PathStrokeType(2.f));
-}
-
-//makes new background image based on width and height of component
-//draws plot graph of the response curve component
-void ResponseCurveComponent::resized(){
-    using namespace juce;
-    background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
-    
-    Graphics g(background);
-    
-    //array of frequencies for drawing plot lines in range 20 Hz - 20 kHz
-    Array<float> freqs{
-        20, 50, 100,
-        200, 500, 1000,
-        2000, 5000, 10000,
-        20000
-    };
-    
-    auto renderArea = getAnalysisArea();
-    auto left = renderArea.getX();
-    auto right = renderArea.getRight();
-    auto top = renderArea.getY();
-    auto bottom = renderArea.getBottom();
-    auto width = renderArea.getWidth();
-    
-    //stores x position for each frequency label within nornalized range to be within bounds of component
-    Array<float> xPos;
-    for(auto f : freqs){
-        auto normX = mapFromLog10(f, 20.f, 20000.f);
-        xPos.add(left + width * normX);
-    }
-    
-    //plots the normalized values
-    g.setColour(Colours::dimgrey);
-    for(auto xs : xPos){
-        //normalizing x value to allow each line to be drawn within the bounds of the response curve component
-        
-        g.drawVerticalLine(xs, top, bottom);
+    //the overlay has its own scale, named in the top right corner of the plot
+    if(overlayChoice == 1 || overlayChoice == 2){
+        const auto& frame = curveWorker.getLatest();
+        const auto& overlayTrace = overlayChoice == 1 ? frame.phase : frame.groupDelay;
+        g.setColour(Colours::gold.withAlpha(0.8f));
+        if(! rasterTraces || ! traceRaster.drawTrace(overlayTrace, 1.5f, Colours::gold.withAlpha(0.8f))){
+            g.strokePath(overlayCurve, PathStrokeType(1.5f));
+        }
+        g.setFont(10);
+        g.drawText(overlayChoice == 1 ? String("Phase -180..180 deg")
+                                      : "Group Delay -" + String(ResponseCurveWorker::MaxGroupDelayMs, 0) + ".."
+                                        + String(ResponseCurveWorker::MaxGroupDelayMs, 0) + " ms",
+                   responseArea.reduced(4).removeFromTop(12),
+                   Justification::centredRight);
     }
     
-    //array of gain units for drawing horizontal plot lines
-    Array<float> gain{
-        -24, -12, 0, 12, 24
-    };
-    
-    //mapping each gain line from gain units to a normalized range between the top and bottom of the component
-    for(auto gDb : gain){
-        auto y = jmap(gDb, -24.f, 24.f, float(bottom), float(top));
-        g.setColour(gDb == 0.f ? Colour(0u, 172u, 1u) : Colours::darkgrey);
-        
-        g.drawHorizontalLine(y, left, right);
+    if(! rasterTraces || ! traceRaster.drawTrace(curveWorker.getLatest().magnitude, 2.f, Colours::white)){
+        g.setColour(Colours::white);
+        g.strokePath(responseCurve, PathStrokeType(2.f));
     }
     
-//    g.drawRect(getAnalysisArea());
-    
-    g.setColour(Colours::lightgrey);
-    const int fontHeight = 10;
-    g.setFont(fontHeight);
-    
-    //drawing labels for each frequency value
-    for(int i = 0; i < freqs.size(); ++i){
-        auto f = freqs[i];
-        auto xs = xPos[i];
-        
-        bool addK = false;
-        String str;
-        if(f > 999.f){
-            addK = true;
-            f /= 1000.f;
-        }
-        
-        str << f;
-        if(addK){
-            str << "k";
-        }
-        str << "Hz";
-        
-        auto textWidth = g.getCurrentFont().getStringWidth(str);
-        
-        Rectangle<int> r;
-        r.setSize(textWidth, fontHeight);
-        r.setCentre(xs, 0);
-        r.setY(1);
-        g.drawFittedText(str, r, juce::Justification::centred, 1);
-    }
+    //everything rasterized above lands on screen here, over the border and overlay label
+    traceRaster.end(g);
+}
+
+//the plot size changed, the analyzer, the curve worker and the background follow it
+void ResponseCurveComponent::resized(){
+    //analyzer frames are produced at the width of the plot, the response curve is rebuilt for it on the next paint
+    analyzer.setDisplayWidth(getAnalysisArea().getWidth());
+    curveWorker.setPlotArea(getAnalysisArea());
     
-    //drawing labels for each gain value
-    for(auto gDb : gain){
-        auto y = jmap(gDb, -24.f, 24.f, float(bottom), float(top));
-        
-        String str;
-        if(gDb > 0){
-            str << "+";
-        }
-        str << gDb;
-        
-        auto textWidth = g.getCurrentFont().getStringWidth(str);
-        
-        //setting bounding box for each label
-        Rectangle<int> r;
-        r.setSize(textWidth, fontHeight);
-        r.setX(getWidth() - textWidth);
-        r.setCentre(r.getCentreX(), y);
-        
-        g.setColour(gDb == 0.f ? Colour(0u, 172u, 1u) : Colours::lightgrey);
-        
-        g.drawFittedText(str, r, juce::Justification::centred, 1);
-        
-        //setting values for spectrum analyzer
-        str.clear();
-        str << (gDb - 24.f);
-        
-        //drawing label within fitted, positioned rectangle
-        r.setX(1);
-        textWidth = g.getCurrentFont().getStringWidth(str);
-        r.setSize(textWidth, fontHeight);
-        g.setColour(Colours::lightgrey);
-        g.drawFittedText(str, r, juce::Justification::centred, 1);
+    updateBackground();
+}
+
+//asks for the background at the current size and display scale, repaints if a cached one could be used at once
+void ResponseCurveComponent::updateBackground(){
+    if(backgroundCache.setKey({ getWidth(), getHeight(), displayScale, getAnalysisArea() })){
+        repaint();
     }
 }
 
@@ -439,45 +382,180 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea(){
     return bounds;
 }
 
-
-//sets the atomic flag to true which will cause the timerCallBack function to execute
-void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue){
-    parametersChanged.set(true);
-}
-
-//checks atomic flag, if true, sets to false and calls updateChain
-//and then signals a repaint
-void ResponseCurveComponent::timerCallback(){
-    //storing data incoming channel fifos
-    juce::AudioBuffer<float> tempIncomingBuffer;
+//asks the curve worker for a new curve whenever the processor published new coefficients
+//repaints once a new curve or analyzer frame has arrived
+bool ResponseCurveComponent::renderFrame(){
+    //the analyzer thread does the FFT work, here we only check whether it finished a new frame
+    analyzer.setSampleRate(audioProcessor.getSampleRate());
+    analyzer.setIsaLevel(audioProcessor.getIsaLevel());
+    traceRaster.setIsaLevel(audioProcessor.getIsaLevel());
+    //view settings are properties of the state tree rather than parameters
+    const auto& state = audioProcessor.apvts.state;
+    //choice index 0..2 maps to order 11..13 and to 50, 75, 87.5 % overlap
+    auto fftChoice = getViewChoice(state, View_FFTSize);
+    auto overlapChoice = getViewChoice(state, View_Overlap);
+    analyzer.setFFTOrder(SpectrumAnalyzer::MinFFTOrder + fftChoice);
+    analyzer.setOverlap(1.f - 0.5f / static_cast<float>(1 << overlapChoice));
+    //smoothing choices are off, 1/12, 1/6 and 1/3 octave
+    static constexpr int smoothingBands[] = {0, 12, 6, 3};
+    analyzer.setSmoothing(smoothingBands[getViewChoice(state, View_Smoothing)]);
+    //a new frame is always handed on to the spectrogram, but only counts as a change for the plot (and keeps the
+    //scheduler at its active rate) when it moved visibly, so silence sitting at the floor lets it go idle
+    auto analyzerFrame = analyzer.pullLatest();
+    auto analyzerChanged = analyzerFrame && analyzerFrameMoved(analyzer.getLatest());
+    
+    //parameter and sample rate changes normally reach the curve through the processor's redesign, so the curve
+    //shows the coefficients the audio is running through
+    //parameters are watched here as well, as without processBlock calls they never produce a new version
+    auto version = audioProcessor.getCoefficientVersion();
+    auto settings = getStereoSettings(audioProcessor.apvts);
+    if(version != curveVersion || ! sameSettings(settings, curveSettings)){
+        curveVersion = version;
+        curveSettings = settings;
+        curveWorker.requestUpdate();
+    }
+    
+    //the worker publishes one point per pixel column, turning them into a path is the only curve work left here
+    //the area the old curves covered has to be repainted along with the new one
+    auto curveArea = responseCurve.getBounds().getUnion(overlayCurve.getBounds());
+    auto curveChanged = curveWorker.pullLatest();
+    if(curveChanged){
+        curveWorker.getLatest().magnitude.buildPath(responseCurve);
+    }
     
-    //while there are buffers to be pulled from left channel FIFO, can be converted into FFT data
-    while(leftChanelFifo->getNumCompleteBuffersAvailable() > 0){
-        if(leftChanelFifo->getAudioBuffer(tempIncomingBuffer)){
-            
+    //overlay choices are off, phase and group delay, all three come with every curve so switching needs no evaluation
+    auto choice = getViewChoice(state, View_CurveOverlay);
+    auto overlayChanged = choice != overlayChoice;
+    if(curveChanged || overlayChanged){
+        overlayChoice = choice;
+        const auto& latest = curveWorker.getLatest();
+        if(overlayChoice == 1){
+            latest.phase.buildPath(overlayCurve);
+        }
+        else if(overlayChoice == 2){
+            latest.groupDelay.buildPath(overlayCurve);
+        }
+        else{
+            overlayCurve.clear();
         }
     }
     
-    if(parametersChanged.compareAndSetBool(false, true)){
-        //update the monoChain
-        updateChain();
-        //signal a repaint
+    //which analyzer traces paint draws
+    auto channels = getViewChoice(state, View_AnalyzerChannels);
+    auto showPre = getViewChoice(state, View_AnalyzerPreEQ) != 0;
+    auto tracesChanged = channels != analyzerChannels || showPre != showPreEQ;
+    analyzerChannels = channels;
+    showPreEQ = showPre;
+    
+    //a new background covers the whole component and is drawn under everything else
+    auto backgroundChanged = backgroundCache.pullLatest();
+    
+    //analyzer traces span the whole plot, the overlay label sits in its corner, a moved curve only needs its own
+    //old and new bounds plus the stroke width
+    if(backgroundChanged){
         repaint();
     }
+    else if(analyzerChanged || overlayChanged || tracesChanged){
+        repaint(getAnalysisArea().expanded(2));
+    }
+    else if(curveChanged){
+        curveArea = curveArea.getUnion(responseCurve.getBounds()).getUnion(overlayCurve.getBounds());
+        repaint(curveArea.expanded(2.f).getSmallestIntegerContainer());
+    }
+    
+    if(analyzerFrame && onAnalyzerFrame){
+        onAnalyzerFrame(analyzer.getLatest());
+    }
+    
+    return analyzerChanged || curveChanged || overlayChanged || tracesChanged || backgroundChanged;
 }
-//updates peak, LC, and HC filters in PluginEditor monoChain object
-void ResponseCurveComponent::updateChain(){
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+
+//true if any trace of the frame is more than half a pixel away from the frame last drawn, levels below the floor
+//are all drawn on it and compare equal, a frame that moved becomes the new reference
+bool ResponseCurveComponent::analyzerFrameMoved(const AnalyzerFrame& frame){
+    auto threshold = 0.5f * -SpectrumAnalyzer::MinDecibels / static_cast<float>(juce::jmax(1, getAnalysisArea().getHeight()));
+    
+    auto moved = false;
+    for(size_t tap = 0; tap < frame.levels.size() && ! moved; ++tap){
+        for(size_t trace = 0; trace < frame.levels[tap].size() && ! moved; ++trace){
+            const auto& levels = frame.levels[tap][trace];
+            const auto& drawn = drawnFrame.levels[tap][trace];
+            if(levels.size() != drawn.size()){
+                moved = true;
+                break;
+            }
+            for(size_t i = 0; i < levels.size(); ++i){
+                auto level = juce::jmax(levels[i], SpectrumAnalyzer::MinDecibels);
+                auto drawnLevel = juce::jmax(drawn[i], SpectrumAnalyzer::MinDecibels);
+                if(std::abs(level - drawnLevel) > threshold){
+                    moved = true;
+                    break;
+                }
+            }
+        }
+    }
     
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    if(moved){
+        drawnFrame = frame;
+    }
+    return moved;
 }
 
+//only repaints when the snapshot actually moved
+bool LevelMeterComponent::renderFrame(){
+    auto latest = audioProcessor.getMeterSnapshot();
+    if(std::memcmp(&latest, &snapshot, sizeof(MeterSnapshot)) == 0){
+        return false;
+    }
+    snapshot = latest;
+    repaint();
+    return true;
+}
 
+void LevelMeterComponent::paint(juce::Graphics& g){
+    using namespace juce;
+    ScopedPaint scopedPaint(*this);
+    g.fillAll(Colours::black);
+    
+    auto bounds = getLocalBounds().reduced(2);
+    auto correlationArea = bounds.removeFromBottom(10);
+    bounds.removeFromBottom(4);
+    
+    auto levelToY = [&bounds](float gain){
+        auto db = jlimit(MinDecibels, MaxDecibels, Decibels::gainToDecibels(gain, MinDecibels));
+        return jmap(db, MinDecibels, MaxDecibels, float(bounds.getBottom()), float(bounds.getY()));
+    };
+    
+    auto barWidth = (bounds.getWidth() - 4) / 2;
+    for(size_t ch = 0; ch < 2; ++ch){
+        auto bar = bounds.withWidth(barWidth).withX(bounds.getX() + static_cast<int>(ch) * (barWidth + 4)).toFloat();
+        g.setColour(Colours::darkgrey);
+        g.fillRect(bar);
+        
+        auto rmsTop = levelToY(snapshot.rms[ch]);
+        g.setColour(Colours::limegreen);
+        g.fillRect(bar.withTop(rmsTop));
+        
+        g.setColour(Colours::white);
+        g.drawHorizontalLine(roundToInt(levelToY(snapshot.peak[ch])), bar.getX(), bar.getRight());
+        
+        g.setColour(snapshot.truePeak[ch] > 1.f ? Colours::red : Colours::orange);
+        g.drawHorizontalLine(roundToInt(levelToY(snapshot.truePeak[ch])), bar.getX(), bar.getRight());
+    }
+    
+    //0 dBFS reference
+    g.setColour(Colours::lightgrey);
+    g.drawHorizontalLine(roundToInt(levelToY(1.f)), float(bounds.getX()), float(bounds.getRight()));
+    
+    //correlation -1 on the left, +1 on the right, marker from the centre
+    g.setColour(Colours::darkgrey);
+    g.fillRect(correlationArea);
+    auto centre = float(correlationArea.getCentreX());
+    auto marker = jmap(snapshot.correlation, -1.f, 1.f, float(correlationArea.getX()), float(correlationArea.getRight()));
+    g.setColour(snapshot.correlation < 0.f ? Colours::red : Colours::skyblue);
+    g.fillRect(Rectangle<float>::leftTopRightBottom(jmin(centre, marker), float(correlationArea.getY()),
+                                                    jmax(centre, marker), float(correlationArea.getBottom())));
+}
 
 //==============================================================================
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
@@ -491,14 +569,31 @@ lowCutFreqSlider(*audioProcessor.apvts.getParameter("LowCut Freq"), "Hz"),
 highCutFreqSlider(*audioProcessor.apvts.getParameter("HighCut Freq"), "Hz"),
 lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope"), "dB/Oct"),
 highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "dB/Oct"),
+peakFreqSlider2(*audioProcessor.apvts.getParameter(getParamID("Peak Freq", 1)), "Hz"),
+peakGainSlider2(*audioProcessor.apvts.getParameter(getParamID("Peak Gain", 1)), "dB"),
+peakQualitySlider2(*audioProcessor.apvts.getParameter(getParamID("Peak Quality", 1)), ""),
+lowCutFreqSlider2(*audioProcessor.apvts.getParameter(getParamID("LowCut Freq", 1)), "Hz"),
+highCutFreqSlider2(*audioProcessor.apvts.getParameter(getParamID("HighCut Freq", 1)), "Hz"),
+lowCutSlopeSlider2(*audioProcessor.apvts.getParameter(getParamID("LowCut Slope", 1)), "dB/Oct"),
+highCutSlopeSlider2(*audioProcessor.apvts.getParameter(getParamID("HighCut Slope", 1)), "dB/Oct"),
 responseCurveComponent(audioProcessor),
+levelMeter(audioProcessor),
 peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
 peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
 peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider),
 lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
 highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
 lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider)
+highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider),
+peakFreqSlider2Attachment(audioProcessor.apvts, getParamID("Peak Freq", 1), peakFreqSlider2),
+peakGainSlider2Attachment(audioProcessor.apvts, getParamID("Peak Gain", 1), peakGainSlider2),
+peakQualitySlider2Attachment(audioProcessor.apvts, getParamID("Peak Quality", 1), peakQualitySlider2),
+lowCutFreqSlider2Attachment(audioProcessor.apvts, getParamID("LowCut Freq", 1), lowCutFreqSlider2),
+highCutFreqSlider2Attachment(audioProcessor.apvts, getParamID("HighCut Freq", 1), highCutFreqSlider2),
+lowCutSlopeSlider2Attachment(audioProcessor.apvts, getParamID("LowCut Slope", 1), lowCutSlopeSlider2),
+highCutSlopeSlider2Attachment(audioProcessor.apvts, getParamID("HighCut Slope", 1), highCutSlopeSlider2),
+linkAttachment(audioProcessor.apvts, "Link Channels", linkButton),
+crossoverAttachment(audioProcessor.apvts, "Crossover", crossoverButton)
 
 {
     // Make sure that before the constructor has finished, you've set the
@@ -523,18 +618,110 @@ highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlope
     highCutSlopeSlider.labels.add({0.f, "12"});
     highCutSlopeSlider.labels.add({1.f, "20kHz"});
     
+    //the second lane's sliders cover the same ranges
+    auto lane0 = getLaneSliders(0);
+    auto lane1 = getLaneSliders(1);
+    for(size_t i = 0; i < lane0.size(); ++i){
+        lane1[i]->labels = lane0[i]->labels;
+    }
     
     //adds slider components and makes them visible
     for(auto* comp : getComps()){
         addAndMakeVisible(comp);
     }
     
-    setSize (600, 480);
+    if(auto* stereoMode = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Stereo Mode"))){
+        stereoModeBox.addItemList(stereoMode->choices, 1);
+    }
+    stereoModeAttachment = std::make_unique<APVTS::ComboBoxAttachment>(audioProcessor.apvts, "Stereo Mode", stereoModeBox);
+    
+    if(auto* stageOrder = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Stage Order"))){
+        stageOrderBox.addItemList(stageOrder->choices, 1);
+    }
+    stageOrderAttachment = std::make_unique<APVTS::ComboBoxAttachment>(audioProcessor.apvts, "Stage Order", stageOrderBox);
+    
+    //the attachments notify synchronously, so a host changing the mode or link updates the lane controls as well
+    stereoModeBox.onChange = [this]{ updateLaneControls(); };
+    linkButton.onClick = [this]{ updateLaneControls(); };
+    for(int lane = 0; lane < 2; ++lane){
+        auto& button = laneButtons[static_cast<size_t>(lane)];
+        button.setRadioGroupId(1);
+        button.setClickingTogglesState(true);
+        button.onClick = [this, lane]{
+            if(laneButtons[static_cast<size_t>(lane)].getToggleState()){
+                shownLane = lane;
+                updateLaneControls();
+            }
+        };
+    }
+    updateLaneControls();
+    
+    //view settings are written to the state tree on every change, and read back whenever it changes or is replaced
+    //the combo boxes' items are in the same order as the settings' choices
+    for(auto [setting, box] : getViewBoxes()){
+        box->addItemList(getViewSettingInfo(setting).choices, 1);
+        box->onChange = [this, setting = setting, box = box]{
+            setViewChoice(audioProcessor.apvts.state, setting, box->getSelectedItemIndex());
+        };
+    }
+    preEQButton.onClick = [this]{
+        setViewChoice(audioProcessor.apvts.state, View_AnalyzerPreEQ, preEQButton.getToggleState() ? 1 : 0);
+    };
+    updateViewControls();
+    audioProcessor.apvts.state.addListener(this);
+    
+    //each analyzer frame becomes one spectrogram column, mid is the trace that represents both channels
+    responseCurveComponent.onAnalyzerFrame = [this](const AnalyzerFrame& frame){
+        spectrogram.pushFrame(frame.levels[Tap_Post][Trace_Mid]);
+    };
+    spectrogram.setFloorDecibels(SpectrumAnalyzer::MinDecibels);
+    
+    //one frame clock for everything that animates, sliders still repaint themselves when they move
+    renderScheduler.addClient(responseCurveComponent);
+    renderScheduler.addClient(spectrogram);
+    renderScheduler.addClient(levelMeter);
+    
+    //a moving knob changes the curve within a block or two, so the scheduler leaves its idle rate straight away
+    for(int lane = 0; lane < 2; ++lane){
+        for(auto* slider : getLaneSliders(lane)){
+            slider->onValueChange = [this]{ renderScheduler.wake(); };
+        }
+    }
+    
+    setSize (600, 620);
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 {
-    
+    audioProcessor.apvts.state.removeListener(this);
+    cancelPendingUpdate();
+}
+
+//the state can change or be replaced by setStateInformation on whatever thread the host calls it from, so the
+//controls follow on the message thread
+//parameter values are properties of the state's children, only properties of the state itself are view settings
+void SimpleEQAudioProcessorEditor::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier&){
+    if(tree == audioProcessor.apvts.state){
+        triggerAsyncUpdate();
+    }
+}
+
+void SimpleEQAudioProcessorEditor::valueTreeRedirected(juce::ValueTree&){
+    triggerAsyncUpdate();
+}
+
+void SimpleEQAudioProcessorEditor::handleAsyncUpdate(){
+    updateViewControls();
+}
+
+void SimpleEQAudioProcessorEditor::updateViewControls(){
+    const auto& state = audioProcessor.apvts.state;
+    for(auto [setting, box] : getViewBoxes()){
+        box->setSelectedItemIndex(getViewChoice(state, setting), juce::dontSendNotification);
+    }
+    preEQButton.setToggleState(getViewChoice(state, View_AnalyzerPreEQ) != 0, juce::dontSendNotification);
+    //the response curve picks the new settings up on its next frame
+    renderScheduler.wake();
 }
 
 //==============================================================================
@@ -559,23 +746,62 @@ void SimpleEQAudioProcessorEditor::resized()
     
     responseCurveComponent.setBounds(responseArea);
     
+    //fixed height strip for the spectrogram and meters between the curve and the sliders
     bounds.removeFromTop(5);
+    auto stripArea = bounds.removeFromTop(80).reduced(10, 0);
+    levelMeter.setBounds(stripArea.removeFromRight(60));
+    stripArea.removeFromRight(5);
+    spectrogram.setBounds(stripArea);
     
-    //region reserved for LC and HC filters
-    auto lowCutArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
-    auto highCutArea = bounds.removeFromRight(bounds.getWidth() * 0.5);
-    
-    lowCutFreqSlider.setBounds(lowCutArea.removeFromTop(lowCutArea.getHeight() * 0.5));
-    lowCutSlopeSlider.setBounds(lowCutArea);
-    highCutFreqSlider.setBounds(highCutArea.removeFromTop(highCutArea.getHeight() * 0.5));
-    highCutSlopeSlider.setBounds(highCutArea);
+    //stereo controls, left to right
+    bounds.removeFromTop(5);
+    auto controlBar = bounds.removeFromTop(24).reduced(10, 0);
+    stereoModeBox.setBounds(controlBar.removeFromLeft(110));
+    controlBar.removeFromLeft(5);
+    linkButton.setBounds(controlBar.removeFromLeft(60));
+    for(auto& button : laneButtons){
+        button.setBounds(controlBar.removeFromLeft(60));
+    }
+    controlBar.removeFromLeft(5);
+    crossoverButton.setBounds(controlBar.removeFromLeft(90));
+    stageOrderBox.setBounds(controlBar.removeFromRight(170));
     
-    //remaining third reserved for peak filter sliders
-    peakFreqSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.33));
-    peakGainSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.5));
-    peakQualitySlider.setBounds(bounds);
+    //analyzer and curve view settings, left to right
+    bounds.removeFromTop(5);
+    auto viewBar = bounds.removeFromTop(24).reduced(10, 0);
+    fftSizeBox.setBounds(viewBar.removeFromLeft(85));
+    viewBar.removeFromLeft(5);
+    overlapBox.setBounds(viewBar.removeFromLeft(105));
+    viewBar.removeFromLeft(5);
+    analyzerChannelsBox.setBounds(viewBar.removeFromLeft(100));
+    viewBar.removeFromLeft(5);
+    preEQButton.setBounds(viewBar.removeFromLeft(65));
+    viewBar.removeFromLeft(5);
+    smoothingBox.setBounds(viewBar.removeFromLeft(100));
+    viewBar.removeFromLeft(5);
+    curveOverlayBox.setBounds(viewBar);
     
+    bounds.removeFromTop(5);
     
+    //both lanes share one layout, only the shown lane is visible
+    for(int lane = 0; lane < 2; ++lane){
+        auto [peakFreq, peakGain, peakQuality, lowCutFreq, highCutFreq, lowCutSlope, highCutSlope] = getLaneSliders(lane);
+        auto area = bounds;
+        
+        //region reserved for LC and HC filters
+        auto lowCutArea = area.removeFromLeft(area.getWidth() * 0.33);
+        auto highCutArea = area.removeFromRight(area.getWidth() * 0.5);
+        
+        lowCutFreq->setBounds(lowCutArea.removeFromTop(lowCutArea.getHeight() * 0.5));
+        lowCutSlope->setBounds(lowCutArea);
+        highCutFreq->setBounds(highCutArea.removeFromTop(highCutArea.getHeight() * 0.5));
+        highCutSlope->setBounds(highCutArea);
+        
+        //remaining third reserved for peak filter sliders
+        peakFreq->setBounds(area.removeFromTop(area.getHeight() * 0.33));
+        peakGain->setBounds(area.removeFromTop(area.getHeight() * 0.5));
+        peakQuality->setBounds(area);
+    }
 }
 
 
@@ -589,6 +815,68 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps(){
         &highCutFreqSlider,
         &highCutSlopeSlider,
         &lowCutSlopeSlider,
-        &responseCurveComponent
+        &peakFreqSlider2,
+        &peakGainSlider2,
+        &peakQualitySlider2,
+        &lowCutFreqSlider2,
+        &highCutFreqSlider2,
+        &highCutSlopeSlider2,
+        &lowCutSlopeSlider2,
+        &stereoModeBox,
+        &linkButton,
+        &laneButtons[0],
+        &laneButtons[1],
+        &crossoverButton,
+        &stageOrderBox,
+        &fftSizeBox,
+        &overlapBox,
+        &analyzerChannelsBox,
+        &preEQButton,
+        &smoothingBox,
+        &curveOverlayBox,
+        &responseCurveComponent,
+        &spectrogram,
+        &levelMeter
     };
 }
+
+std::vector<std::pair<ViewSetting, juce::ComboBox*>> SimpleEQAudioProcessorEditor::getViewBoxes(){
+    return {
+        { View_FFTSize, &fftSizeBox },
+        { View_Overlap, &overlapBox },
+        { View_AnalyzerChannels, &analyzerChannelsBox },
+        { View_Smoothing, &smoothingBox },
+        { View_CurveOverlay, &curveOverlayBox }
+    };
+}
+
+std::array<RotarySliderWithLabels*, 7> SimpleEQAudioProcessorEditor::getLaneSliders(int lane){
+    if(lane == 0){
+        return { &peakFreqSlider, &peakGainSlider, &peakQualitySlider,
+                 &lowCutFreqSlider, &highCutFreqSlider, &lowCutSlopeSlider, &highCutSlopeSlider };
+    }
+    return { &peakFreqSlider2, &peakGainSlider2, &peakQualitySlider2,
+             &lowCutFreqSlider2, &highCutFreqSlider2, &lowCutSlopeSlider2, &highCutSlopeSlider2 };
+}
+
+void SimpleEQAudioProcessorEditor::updateLaneControls(){
+    auto midSide = stereoModeBox.getSelectedItemIndex() == Stereo_MidSide;
+    //linking only applies to L/R, M/S always has a separate side set
+    auto linked = ! midSide && linkButton.getToggleState();
+    
+    linkButton.setEnabled(! midSide);
+    laneButtons[0].setButtonText(midSide ? "Mid" : "Left");
+    laneButtons[1].setButtonText(midSide ? "Side" : "Right");
+    laneButtons[1].setEnabled(! linked);
+    if(linked){
+        shownLane = 0;
+    }
+    laneButtons[static_cast<size_t>(shownLane)].setToggleState(true, juce::dontSendNotification);
+    responseCurveComponent.setShownLane(shownLane);
+    
+    for(int lane = 0; lane < 2; ++lane){
+        for(auto* slider : getLaneSliders(lane)){
+            slider->setVisible(lane == shownLane);
+        }
+    }
+}
@@ -10,8 +10,20 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SpectrumAnalyzer.h"
+#include "Spectrogram.h"
+#include "ResponseCurve.h"
+#include "RenderScheduler.h"
+#include "KnobSprites.h"
+#include "PlotBackground.h"
+#include "TraceRaster.h"
+
+#include <array>
+#include <memory>
 
 //inherits from LookAndFeel_V4 to allow drawing of custom rotary slider
+//one instance is shared by every slider through a SharedResourcePointer, so knob sprites rendered for one slider
+//are reused by every other slider of the same size
 struct LookAndFeel : juce::LookAndFeel_V4{
     void drawRotarySlider (juce::Graphics& g,
                                    int x, int y, int width, int height,
@@ -19,13 +31,25 @@ struct LookAndFeel : juce::LookAndFeel_V4{
                                    float rotaryStartAngle,
                                    float rotaryEndAngle,
                            juce::Slider& slider) override;
+    
+    //blits the cached body and pointer sprites for this size at the context's physical scale
+    void drawKnob(juce::Graphics& g, juce::Rectangle<int> bounds, float sliderPosProportional,
+                  float rotaryStartAngle, float rotaryEndAngle, float pointerInset);
+    
+private:
+    //one entry per knob size and scale seen, the oldest is dropped once the editor has been resized or moved
+    //between displays often enough to fill it
+    static constexpr size_t MaxSpriteSets = 8;
+    std::vector<std::unique_ptr<KnobSprites>> spriteSets;
+    
+    KnobSprites& getSprites(const KnobSprites::Key& key);
 };
 
 //custom rotary slider class inheriting from the juce::Slider class
 struct RotarySliderWithLabels : juce::Slider{
     RotarySliderWithLabels(juce::RangedAudioParameter& rap, const juce::String& unitSuffix) : juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag,
                                       juce::Slider::TextEntryBoxPosition::NoTextBox), param(&rap), suffix(unitSuffix){
-      setLookAndFeel(&lnf);
+      setLookAndFeel(lnf.get());
   }
     
     ~RotarySliderWithLabels(){
@@ -47,14 +71,48 @@ struct RotarySliderWithLabels : juce::Slider{
     int getTextHeight() const {return 14;}
     //returns the display text itself
     juce::String getDisplayString() const;
+    
+    //draws the value text in its box centred on centre, laid out again only when the slider value changed
+    void drawValueLabel(juce::Graphics& g, juce::Point<float> centre);
+    
+    void resized() override;
 private:
     //param value associated with each slider that will allow each slider to display param values along with modifying them
     juce::RangedAudioParameter* param;
     //suffix associated with each parameter i.e. Hz for filter freq, dB/Oct for cut filter slopes, dB for peak gain
     juce::String suffix;
     
-    //in charge of drawing the custom rotary sliders
-    LookAndFeel lnf;
+    //in charge of drawing the custom rotary sliders, shared by all instances
+    juce::SharedResourcePointer<LookAndFeel> lnf;
+    
+    //value text as last laid out around (0, 0), keyed by the slider value it was built for
+    struct ValueLabel{
+        double value { std::numeric_limits<double>::quiet_NaN() };
+        juce::GlyphArrangement glyphs;
+        juce::Rectangle<float> box;
+    } valueLabel;
+    
+    //min and max labels around the knob, laid out on the first paint after the bounds changed
+    juce::GlyphArrangement rangeLabels;
+    bool rangeLabelsValid { false };
+    void layoutRangeLabels();
+};
+
+//vertical L/R bars (RMS filled, held peak as a line, true peak marker turning red over 0 dBTP) above a horizontal
+//correlation bar, polled from the processor's lock free meter snapshot once per scheduler frame
+struct LevelMeterComponent : juce::Component, RenderScheduler::Client{
+    LevelMeterComponent(SimpleEQAudioProcessor& p) : audioProcessor(p){}
+    
+    bool renderFrame() override;
+    void paint(juce::Graphics& g) override;
+    
+private:
+    SimpleEQAudioProcessor& audioProcessor;
+    MeterSnapshot snapshot;
+    
+    //bars cover -48 dB to +6 dB
+    static constexpr float MinDecibels = -48.f;
+    static constexpr float MaxDecibels = 6.f;
 };
 
 //==============================================================================
@@ -63,66 +121,51 @@ private:
 //struct in charging of drawing the response curve
 //ResponseCurveComponent only controls its own bounds so it will only draw within its own bounds
 struct ResponseCurveComponent : juce::Component,
-juce::AudioProcessorParameter::Listener,
-juce::Timer
+RenderScheduler::Client
 {
     ResponseCurveComponent(SimpleEQAudioProcessor&);
     ~ResponseCurveComponent();
     
-    /** Receives a callback when a parameter has been changed.
-
-        IMPORTANT NOTE: This will be called synchronously when a parameter changes, and
-        many audio processors will change their parameter during their audio callback.
-        This means that not only has your handler code got to be completely thread-safe,
-        but it's also got to be VERY fast, and avoid blocking. If you need to handle
-        this event on your message thread, use this callback to trigger an AsyncUpdater
-        or ChangeBroadcaster which you can respond to on the message thread.
-    */
-    void parameterValueChanged (int parameterIndex, float newValue) override;
-
-    /** Indicates that a parameter change gesture has started.
-
-        E.g. if the user is dragging a slider, this would be called with gestureIsStarting
-        being true when they first press the mouse button, and it will be called again with
-        gestureIsStarting being false when they release it.
-
-        IMPORTANT NOTE: This will be called synchronously, and many audio processors will
-        call it during their audio callback. This means that not only has your handler code
-        got to be completely thread-safe, but it's also got to be VERY fast, and avoid
-        blocking. If you need to handle this event on your message thread, use this callback
-        to trigger an AsyncUpdater or ChangeBroadcaster which you can respond to later on the
-        message thread.
-    */
-    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override{}
-    
-    /** The user-defined callback routine that actually gets called periodically.
-
-        It's perfectly ok to call startTimer() or stopTimer() from within this
-        callback to change the subsequent intervals.
-    */
-    void timerCallback() override;
+    //pulls the latest curve and analyzer frame, repaints the plot for a new analyzer frame and only the area the
+    //curve moved through when just the curve changed
+    bool renderFrame() override;
     
     void paint(juce::Graphics& g) override;
     
     void resized() override;
     
+    //called from renderFrame with every new analyzer frame, after the curve has been told to repaint
+    std::function<void(const AnalyzerFrame&)> onAnalyzerFrame;
+    
+    //lane whose response the curve shows, follows the editor's lane buttons
+    void setShownLane(int lane) { curveWorker.setLane(lane); }
+    
     //returns the area in which the background and response curve will be drawn
     
 
 private:
     SimpleEQAudioProcessor& audioProcessor;
     
-    //will be set to true by the parameterValueChanged function to trigger a repaint of the responseCurve
-    juce::Atomic<bool> parametersChanged {false};
-    
-    //instance of monochain needed to draw the response curve as copies of parameter values are needed
-    MonoChain monoChain;
+    //coefficient version the last curve update was requested for, the processor bumps it with every redesign
+    juce::uint64 curveVersion { 0 };
+    //parameters the last curve update was requested for
+    StereoSettings curveSettings;
     
-    //updates the monoChain's values, called in timerCallback and constructor
-    void updateChain();
+    //designs the filters and evaluates the curve on its own thread, paint only strokes the path built from its points
+    ResponseCurveWorker curveWorker;
+    juce::Path responseCurve;
+    //phase or group delay drawn under the magnitude, picked by the curve overlay view setting, -1 until the first frame
+    juce::Path overlayCurve;
+    int overlayChoice { -1 };
+    //analyzer traces drawn, as of the last frame
+    int analyzerChannels { 0 };
+    bool showPreEQ { false };
     
-    //prerendered Image for response curve background plot
-    juce::Image background;
+    //prerendered images for the response curve background plot, keyed by size and display scale
+    PlotBackgroundCache backgroundCache;
+    //physical pixels per logical pixel as of the last paint
+    float displayScale { 1.f };
+    void updateBackground();
     
     //draws region for rendering the component i.e the background region
     juce::Rectangle<int> getRenderArea();
@@ -130,10 +173,20 @@ private:
     //horizontal bounds of plot do not lie directly on edges of render area
     juce::Rectangle<int> getAnalysisArea();
     
-    SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>* leftChanelFifo;
+    //drains both channel FIFOs and runs the FFTs on its own thread, paint only draws its latest frame
+    SpectrumAnalyzer analyzer;
+    //levels of the last analyzer frame that counted as a change
+    AnalyzerFrame drawnFrame;
+    bool analyzerFrameMoved(const AnalyzerFrame& frame);
+    
+    //draws the analyzer and curve traces in paint, analyzerY holds one analyzer trace mapped to the plot
+    TraceRaster traceRaster;
+    std::vector<float> analyzerY;
 };
 
-class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor,
+private juce::ValueTree::Listener,
+private juce::AsyncUpdater
 {
 public:
     SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor&);
@@ -158,7 +211,35 @@ private:
     lowCutSlopeSlider,
     highCutSlopeSlider;
     
+    //second lane's set, the right channel when unlinked or the side channel in M/S mode
+    RotarySliderWithLabels peakFreqSlider2,
+    peakGainSlider2,
+    peakQualitySlider2,
+    lowCutFreqSlider2,
+    highCutFreqSlider2,
+    lowCutSlopeSlider2,
+    highCutSlopeSlider2;
+    
+    //stereo controls in the bar above the sliders, the lane buttons pick which set of sliders is shown
+    juce::ComboBox stereoModeBox;
+    juce::ToggleButton linkButton { "Link" }, crossoverButton { "Crossover" };
+    std::array<juce::TextButton, 2> laneButtons;
+    int shownLane { 0 };
+    //order of the filter stages, at the right end of the bar
+    juce::ComboBox stageOrderBox;
+    
+    //view settings in a second bar, stored in the state tree instead of parameters, see ViewSetting
+    juce::ComboBox fftSizeBox, overlapBox, analyzerChannelsBox, smoothingBox, curveOverlayBox;
+    juce::ToggleButton preEQButton { "Pre EQ" };
+    
+    //frame clock for the components below, declared first so it outlives them
+    RenderScheduler renderScheduler;
+    
     ResponseCurveComponent responseCurveComponent;
+    //scrolling history of the post EQ mid trace underneath the response curve
+    SpectrogramComponent spectrogram;
+    //output levels and correlation next to the spectrogram
+    LevelMeterComponent levelMeter;
     
     //alias for attaching the parameter value each slider represents
     using APVTS = juce::AudioProcessorValueTreeState;
@@ -172,8 +253,36 @@ private:
     lowCutSlopeSliderAttachment,
     highCutSlopeSliderAttachment;
     
+    Attachment peakFreqSlider2Attachment,
+    peakGainSlider2Attachment,
+    peakQualitySlider2Attachment,
+    lowCutFreqSlider2Attachment,
+    highCutFreqSlider2Attachment,
+    lowCutSlopeSlider2Attachment,
+    highCutSlopeSlider2Attachment;
+    
+    //the combo box attachments select the parameter's item when they are made, so they are created once the items are in
+    std::unique_ptr<APVTS::ComboBoxAttachment> stereoModeAttachment, stageOrderAttachment;
+    APVTS::ButtonAttachment linkAttachment, crossoverAttachment;
+    
     //returns a vector of sliders
     std::vector<juce::Component*> getComps();
+    
+    //the view setting combo boxes with the setting each one shows
+    std::vector<std::pair<ViewSetting, juce::ComboBox*>> getViewBoxes();
+    
+    //selects the view controls' items from the state tree without writing them back
+    void updateViewControls();
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+    void valueTreeRedirected(juce::ValueTree& tree) override;
+    void handleAsyncUpdate() override;
+    
+    //one lane's sliders in the same order for both lanes
+    std::array<RotarySliderWithLabels*, 7> getLaneSliders(int lane);
+    
+    //names the lane buttons after the stereo mode, shows the selected lane's sliders and falls back to the first
+    //lane while the channels are linked, as the second set does nothing then
+    void updateLaneControls();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessorEditor)
 };
@@ -9,6 +9,8 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+#include <thread>
+
 //==============================================================================
 SimpleEQAudioProcessor::SimpleEQAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -18,14 +20,33 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       //band outputs for crossover mode, disabled until the host asks for them
+                       .withOutput ("Low", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Mid", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("High", juce::AudioChannelSet::stereo(), false)
                      #endif
                        )
 #endif
 {
+    //parameters that change the shape of the processing graph rather than the coefficients
+    for(auto* id : {"Stage Order", "Stereo Mode", "Crossover"}){
+        apvts.addParameterListener(id, this);
+    }
+    
+    activeSchedule = compileSchedule(getGraphDescription(apvts));
+    startTimerHz(30);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    for(auto* id : {"Stage Order", "Stereo Mode", "Crossover"}){
+        apvts.removeParameterListener(id, this);
+    }
+    stopTimer();
+    
+    //no audio thread is running any more, so everything can go
+    delete pendingSchedule.exchange(nullptr);
+    delete retiredSchedule.exchange(nullptr);
 }
 
 //==============================================================================
@@ -96,23 +117,23 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     
-    //pass a process spec object to each Chain which will then be passed to each link in the chain
-    juce::dsp::ProcessSpec spec;
-    //max number of samples processed at 1 time
-    spec.maximumBlockSize = samplesPerBlock;
-    //number of channels: 1 because mono can only handle 1 channel of audio
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    //sample rate is read through getSampleRate() when coefficients are designed, so the only per playback state
+    //the stereo cascade needs is cleared filter memory and a full redesign
+    cascadeState = {};
+    crossover.reset();
+    designedSampleRate = 0.0;
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    //cpu features are checked once here rather than per block, SIMPLEEQ_ISA or setIsaOverride() can force a level
+    isaLevel.store(selectIsaLevel());
+    processSections = getStereoSectionsKernel(isaLevel.load());
+    meter.setIsaLevel(isaLevel.load());
     
     updateFilters();
     
-    //preparing FIFOs data structures for processing by FFT algorithm
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    //true peak oversampler is sized for the host block size
+    meter.prepare(sampleRate, samplesPerBlock);
     
+    //the analyzer FIFOs have a fixed frame size, so they are allocated when an analyzer subscribes, not here
 }
 
 void SimpleEQAudioProcessor::releaseResources()
@@ -142,6 +163,14 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
         return false;
    #endif
 
+    // The crossover band outputs are either disabled or match the main output
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+    {
+        const auto& set = layouts.getChannelSet (false, bus);
+        if (! set.isDisabled() && set != layouts.getMainOutputChannelSet())
+            return false;
+    }
+
     return true;
   #endif
 }
@@ -170,26 +199,156 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     
     
     
-    //need to extract L and R channel from the buffer to the processing context
-    //which will then be passed to the processor chain and ran through each link
+    //L and R channel live at 0 and 1 index in the buffer, a mono layout passes its one channel as both, which is only
+    //correct because updateFilters() designs lane 1 as a copy of lane 0 for a mono bus, see there
+    auto* left = buffer.getWritePointer(0);
+    auto* right = getMainBusNumOutputChannels() > 1 ? buffer.getWritePointer(1) : left;
+    
+    //pre EQ tap, the FIFOs are pushed in the order the analyzer expects and capture stops at the first full one
+    //so all four keep the same blocks, see SpectrumAnalyzer::run
+    auto capture = beginAnalyzerCapture();
+    capture = capture && leftPreFifo.update(buffer) && rightPreFifo.update(buffer);
+    
+    //graph changes only ever take effect here, between blocks
+    pickUpSchedule();
+    if(activeSchedule != nullptr){
+        runSchedule(*activeSchedule, buffer, left, right);
+    }
+    
+    //post EQ tap, the analyzer releases frames in reverse order so these have at least the room the pre FIFOs had
+    if(capture){
+        leftChannelFifo.update(buffer);
+        rightChannelFifo.update(buffer);
+    }
+    capturing.store(false);
+    
+    //meters are display only as well, nobody reads them without an editor
+    if(analyzerSubscribers.load(std::memory_order_relaxed) > 0){
+        meter.process(left, right, buffer.getNumSamples());
+    }
+}
+
+//capturing is raised before the subscriber count is checked and removeAnalyzerSubscriber() clears the count before
+//it checks capturing, both sequentially consistent, so either this block sees no subscribers or the message
+//thread sees the writes in flight and waits for processBlock to lower the flag again
+bool SimpleEQAudioProcessor::beginAnalyzerCapture(){
+    if(analyzerSubscribers.load(std::memory_order_relaxed) == 0){
+        return false;
+    }
+    
+    capturing.store(true);
+    return analyzerSubscribers.load() > 0;
+}
+
+void SimpleEQAudioProcessor::addAnalyzerSubscriber(){
+    //nothing is writing while the count is zero, so the FIFOs can be allocated before capture starts
+    if(analyzerSubscribers.load() == 0){
+        leftPreFifo.prepare();
+        rightPreFifo.prepare();
+        leftChannelFifo.prepare();
+        rightChannelFifo.prepare();
+    }
+    analyzerSubscribers.fetch_add(1);
+}
+
+void SimpleEQAudioProcessor::removeAnalyzerSubscriber(){
+    jassert(analyzerSubscribers.load() > 0);
+    if(analyzerSubscribers.fetch_sub(1) != 1){
+        return;
+    }
+    
+    //last one gone, wait out a block that started capturing before the count dropped
+    while(capturing.load()){
+        std::this_thread::yield();
+    }
+    leftPreFifo.release();
+    rightPreFifo.release();
+    leftChannelFifo.release();
+    rightChannelFifo.release();
+}
+
+//runs each op of the compiled schedule over the whole block
+//bypassed slots are filtered out per op into a list on the stack, so nothing is allocated here
+void SimpleEQAudioProcessor::runSchedule(const ProcessingSchedule& schedule,
+                                         juce::AudioBuffer<float>& buffer,
+                                         float* left,
+                                         float* right){
+    auto numSamples = buffer.getNumSamples();
     
-    juce::dsp::AudioBlock<float> block(buffer);
+    for(const auto& op : schedule.ops){
+        if(op.kind == ScheduleOp::Sections){
+            std::array<int, MaxCascadeSlots> slots;
+            int numSlots = 0;
+            for(int i = 0; i < op.numSlots; ++i){
+                if(cascade.active[op.slots[i]]){
+                    slots[numSlots++] = op.slots[i];
+                }
+            }
+            //a mono bus has no side signal, so the M/S round trip is skipped rather than run on identical lanes
+            auto midSide = left != right;
+            processSections(cascade.sections.data(), cascadeState, slots.data(), numSlots,
+                            left, right, numSamples, op.encodeMidSide && midSide, op.decodeMidSide && midSide);
+        }
+        else{
+            //the main output carries the recombined bands and each enabled band bus gets its own band
+            CrossoverOutputs outputs;
+            auto getBand = [this, &buffer](int bus, std::array<float*, 2>& band){
+                auto* outputBus = getBus(false, bus);
+                if(outputBus == nullptr || ! outputBus->isEnabled()){
+                    return;
+                }
+                auto busBuffer = getBusBuffer(buffer, false, bus);
+                for(int ch = 0; ch < juce::jmin(2, busBuffer.getNumChannels()); ++ch){
+                    band[ch] = busBuffer.getWritePointer(ch);
+                }
+            };
+            getBand(1, outputs.low);
+            getBand(2, outputs.mid);
+            getBand(3, outputs.high);
+            
+            crossover.process(left, right, outputs, numSamples);
+        }
+    }
+}
+
+void SimpleEQAudioProcessor::pickUpSchedule(){
+    auto offline = isNonRealtime();
     
-    //L and R channel live at 0 and 1 index in the audio block
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    //offline there is no deadline, so the graph is compiled for this very block instead of waiting for the timer
+    if(offline && graphChanged.exchange(false)){
+        delete pendingSchedule.exchange(compileSchedule(getGraphDescription(apvts)).release());
+    }
     
-    //process contexts to wrap the L and R channels
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    //in real time nothing is freed here, the old schedule goes to the timer through a single slot, and while that
+    //slot is still full the new schedule waits a block or two
+    if(! offline && retiredSchedule.load() != nullptr){
+        return;
+    }
     
-    //pass contexts to L and R mono chains to process audio
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    if(auto* next = pendingSchedule.exchange(nullptr)){
+        std::unique_ptr<ProcessingSchedule> old(activeSchedule.release());
+        activeSchedule.reset(next);
+        if(! offline){
+            retiredSchedule.store(old.release());
+        }
+    }
+}
+
+//graph parameters can be automated from the audio thread, so this only raises a flag
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue){
+    juce::ignoreUnused(parameterID, newValue);
+    graphChanged.store(true);
+}
+
+//the audio thread only empties pendingSchedule and only fills retiredSchedule while it is empty, so whatever
+//comes out of either exchange here is no longer reachable from processBlock
+void SimpleEQAudioProcessor::timerCallback(){
+    delete retiredSchedule.exchange(nullptr);
     
-    //update right and left channel FIFOs with buffer
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);    
+    if(graphChanged.exchange(false)){
+        //a schedule replaced before the audio thread took it never ran
+        delete pendingSchedule.exchange(compileSchedule(getGraphDescription(apvts)).release());
+    }
 }
 
 //==============================================================================
@@ -219,83 +378,297 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    //the audio thread is the only one designing and publishing coefficients, so it is only told to redesign
+    //everything at the start of its next block (or in prepareToPlay)
     if(tree.isValid()){
         apvts.replaceState(tree);
-        updateFilters();
+        redesignPending.store(true);
     }
 }
 
+juce::String getParamID(const juce::String& name, int lane){
+    return lane == 0 ? name : name + " 2";
+}
+
+const ViewSettingInfo& getViewSettingInfo(ViewSetting setting){
+    //FFT size and overlap choices map to order 11..13 and to 50, 75, 87.5 % in the editor, Pre EQ is off or on
+    static const std::array<ViewSettingInfo, NumViewSettings> infos {{
+        { "AnalyzerFFTSize", { "FFT 2048", "FFT 4096", "FFT 8192" }, 1 },
+        { "AnalyzerOverlap", { "Overlap 50%", "Overlap 75%", "Overlap 87.5%" }, 1 },
+        { "AnalyzerChannels", { "Left/Right", "Mid/Side", "All Channels" }, 0 },
+        { "AnalyzerPreEQ", { "Off", "On" }, 0 },
+        { "AnalyzerSmoothing", { "No Smoothing", "1/12 Octave", "1/6 Octave", "1/3 Octave" }, 2 },
+        { "CurveOverlay", { "No Overlay", "Phase", "Group Delay" }, 0 }
+    }};
+    return infos[static_cast<size_t>(setting)];
+}
+
+int getViewChoice(const juce::ValueTree& state, ViewSetting setting){
+    const auto& info = getViewSettingInfo(setting);
+    int choice = state.getProperty(info.property, info.defaultChoice);
+    return juce::isPositiveAndBelow(choice, info.choices.size()) ? choice : info.defaultChoice;
+}
+
+void setViewChoice(juce::ValueTree& state, ViewSetting setting, int choice){
+    state.setProperty(getViewSettingInfo(setting).property, choice, nullptr);
+}
+
 //gets current paramter values from the apvts which stores them
 //must use getRawParamterValue() method to return a non-normalized value for each
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts){
+//lane 0 reads the original parameters, lane 1 reads the second parameter set
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, int lane){
     ChainSettings settings;
     
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
+    auto get = [&apvts, lane](const juce::String& name){
+        return apvts.getRawParameterValue(getParamID(name, lane))->load();
+    };
+    
+    settings.lowCutFreq = get("LowCut Freq");
+    settings.highCutFreq = get("HighCut Freq");
+    settings.peakFreq = get("Peak Freq");
+    settings.peakGainInDecibels = get("Peak Gain");
+    settings.peakQuality = get("Peak Quality");
+    settings.lowCutSlope = static_cast<Slope>(get("LowCut Slope"));
+    settings.highCutSlope = static_cast<Slope>(get("HighCut Slope"));
     
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings &chainSettings, double sampleRate){
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                                chainSettings.peakFreq,
-                                                                chainSettings.peakQuality,
-                                                                juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+//linked L/R runs both lanes from the original parameter set
+//unlinked L/R (dual mono) and M/S give the right/side lane the second set
+StereoSettings getStereoSettings(juce::AudioProcessorValueTreeState& apvts){
+    StereoSettings settings;
+    
+    settings.mode = static_cast<StereoMode>(apvts.getRawParameterValue("Stereo Mode")->load());
+    settings.linked = settings.mode == Stereo_LeftRight && apvts.getRawParameterValue("Link Channels")->load() > 0.5f;
+    settings.lanes[0] = getChainSettings(apvts, 0);
+    settings.lanes[1] = settings.linked ? settings.lanes[0] : getChainSettings(apvts, 1);
+    settings.crossover = apvts.getRawParameterValue("Crossover")->load() > 0.5f;
+    
+    return settings;
 }
 
-//uses makePeakFilter method to get new peak coefficients
-//updatees peak coefficient values of left and right mono chains
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings){
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
-    
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+bool sameSettings(const StereoSettings& a, const StereoSettings& b){
+    if(a.mode != b.mode || a.linked != b.linked || a.crossover != b.crossover){
+        return false;
+    }
+    for(size_t lane = 0; lane < a.lanes.size(); ++lane){
+        const auto& x = a.lanes[lane];
+        const auto& y = b.lanes[lane];
+        if(x.peakFreq != y.peakFreq || x.peakGainInDecibels != y.peakGainInDecibels || x.peakQuality != y.peakQuality
+           || x.lowCutFreq != y.lowCutFreq || x.highCutFreq != y.highCutFreq
+           || x.lowCutSlope != y.lowCutSlope || x.highCutSlope != y.highCutSlope){
+            return false;
+        }
+    }
+    return true;
 }
 
-//helper method to be used for updating coefficient values on initialization and changes to filter parameters
-//this function needs to be free as it will be called in pluginProcessorEditor to allow for repaints
-void /*SimpleEQAudioProcessor::*/updateCoefficients(const Coefficients &old, const Coefficients &replacements){
-    *old = *replacements;
+//a band only needs to be redesigned when one of its own settings changed for a lane that is designed
+//or when the linked state changed, which changes what lane 1 holds
+static bool bandChanged(const StereoSettings& current, const StereoSettings& designed,
+                        bool (*sameBand)(const ChainSettings&, const ChainSettings&)){
+    if(current.linked != designed.linked){
+        return true;
+    }
+    for(int lane = 0; lane < current.getNumDesignLanes(); ++lane){
+        if(! sameBand(current.lanes[lane], designed.lanes[lane])){
+            return true;
+        }
+    }
+    return false;
 }
 
-//uses HPHO Butterworth method to get new coefficients based on current LC freq and slope
-//individual links of each mono chain are then updated based on new coefficients
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings){
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-    
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+static bool samePeak(const ChainSettings& a, const ChainSettings& b){
+    return a.peakFreq == b.peakFreq && a.peakQuality == b.peakQuality && a.peakGainInDecibels == b.peakGainInDecibels;
+}
+
+static bool sameLowCut(const ChainSettings& a, const ChainSettings& b){
+    return a.lowCutFreq == b.lowCutFreq && a.lowCutSlope == b.lowCutSlope;
+}
+
+static bool sameHighCut(const ChainSettings& a, const ChainSettings& b){
+    return a.highCutFreq == b.highCutFreq && a.highCutSlope == b.highCutSlope;
+}
+
+//designs the peak section for every lane in a single call
+static void designPeakBand(StereoCascade& cascade, const StereoSettings& stereoSettings, double sampleRate){
+    const auto& l = stereoSettings.lanes;
+    designPeakSection(cascade.sections[PeakSlot],
+                      sampleRate,
+                      {l[0].peakFreq, l[1].peakFreq},
+                      {l[0].peakQuality, l[1].peakQuality},
+                      {l[0].peakGainInDecibels, l[1].peakGainInDecibels},
+                      stereoSettings.getNumDesignLanes());
+}
+
+//Butterworth high pass sections for every lane based on current LC freq and slope, designed in a single call
+static void designLowCutBand(StereoCascade& cascade, const StereoSettings& stereoSettings, double sampleRate){
+    const auto& l = stereoSettings.lanes;
+    designCutSections(&cascade.sections[LowCutSlot],
+                      true,
+                      sampleRate,
+                      {l[0].lowCutFreq, l[1].lowCutFreq},
+                      {l[0].lowCutSlope, l[1].lowCutSlope},
+                      stereoSettings.getNumDesignLanes());
+}
+
+//Butterworth low pass sections for every lane based on current HC freq and slope, designed in a single call
+static void designHighCutBand(StereoCascade& cascade, const StereoSettings& stereoSettings, double sampleRate){
+    const auto& l = stereoSettings.lanes;
+    designCutSections(&cascade.sections[HighCutSlot],
+                      false,
+                      sampleRate,
+                      {l[0].highCutFreq, l[1].highCutFreq},
+                      {l[0].highCutSlope, l[1].highCutSlope},
+                      stereoSettings.getNumDesignLanes());
+}
+
+//a cut slot is active when at least one lane's slope needs it
+//in crossover mode the schedule leaves the cut slots out entirely, the display copy marks them inactive as well
+static void setActiveSlots(StereoCascade& cascade, const StereoSettings& stereoSettings, bool forDisplay){
+    const auto& l = stereoSettings.lanes;
+    auto hideCuts = forDisplay && stereoSettings.crossover;
+    for(int i = 0; i < 4; ++i){
+        cascade.active[LowCutSlot + i] = ! hideCuts && i <= juce::jmax(l[0].lowCutSlope, l[1].lowCutSlope);
+        cascade.active[HighCutSlot + i] = ! hideCuts && i <= juce::jmax(l[0].highCutSlope, l[1].highCutSlope);
+    }
+    cascade.active[PeakSlot] = true;
+}
+
+void designCascade(StereoCascade& cascade, const StereoSettings& settings, double sampleRate){
+    designLowCutBand(cascade, settings, sampleRate);
+    designPeakBand(cascade, settings, sampleRate);
+    designHighCutBand(cascade, settings, sampleRate);
+    setActiveSlots(cascade, settings, true);
+}
+
+void SimpleEQAudioProcessor::updatePeakFilter(const StereoSettings &stereoSettings){
+    designPeakBand(cascade, stereoSettings, getSampleRate());
+}
+
+void SimpleEQAudioProcessor::updateLowCutFilters(const StereoSettings &stereoSettings){
+    designLowCutBand(cascade, stereoSettings, getSampleRate());
+}
+
+void SimpleEQAudioProcessor::updateHighCutFilters(const StereoSettings &stereoSettings){
+    designHighCutBand(cascade, stereoSettings, getSampleRate());
+}
+
+//lane 0's LC and HC frequencies become the lower and upper Linkwitz-Riley split points of both channels
+//the split runs after the M/S decode, so in M/S mode lane 1 holds side settings that have nothing to do with the
+//right channel, and even in dual mono different splits per channel would no longer sum flat across the image
+void SimpleEQAudioProcessor::updateCrossover(const StereoSettings &stereoSettings){
+    const auto& l = stereoSettings.lanes;
+    crossover.design(getSampleRate(),
+                     {l[0].lowCutFreq, l[0].lowCutFreq},
+                     {l[0].highCutFreq, l[0].highCutFreq});
 }
 
-//uses LPHO Butterworth method to get new coefficients based on current HC freq and slope
-//individual links of each mono chain are then updated based on new coefficients
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings){
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
+//stage order picks the order of the filter stages, M/S mode wraps them in an encode/decode pair
+//and in crossover mode the cut stages give way to the split, which ends the graph
+GraphDescription getGraphDescription(juce::AudioProcessorValueTreeState& apvts){
+    auto order = static_cast<StageOrder>(apvts.getRawParameterValue("Stage Order")->load());
+    auto midSide = static_cast<StereoMode>(apvts.getRawParameterValue("Stereo Mode")->load()) == Stereo_MidSide;
+    auto crossover = apvts.getRawParameterValue("Crossover")->load() > 0.5f;
+    
+    std::vector<GraphStage> filters;
+    switch(order){
+        case Order_PeakLowCutHighCut:
+            filters = {GraphStage::Peak, GraphStage::LowCut, GraphStage::HighCut};
+            break;
+        case Order_LowCutHighCutPeak:
+            filters = {GraphStage::LowCut, GraphStage::HighCut, GraphStage::Peak};
+            break;
+        case Order_LowCutPeakHighCut:
+        default:
+            filters = {GraphStage::LowCut, GraphStage::Peak, GraphStage::HighCut};
+            break;
+    }
+    
+    GraphDescription graph;
+    if(midSide){
+        graph.stages.push_back(GraphStage::MidSideEncode);
+    }
+    for(auto stage : filters){
+        if(crossover && stage != GraphStage::Peak){
+            continue;
+        }
+        graph.stages.push_back(stage);
+    }
+    if(midSide){
+        graph.stages.push_back(GraphStage::MidSideDecode);
+    }
+    if(crossover){
+        graph.stages.push_back(GraphStage::Crossover);
+    }
     
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    return graph;
 }
 
-//initializes a chainSettings object which holds all current parameters values
-//calls functions to update LC, HC, and Peak filters with chainSetting object
+//initializes a StereoSettings object which holds all current parameters values for both lanes
+//only the bands whose settings changed since the last call are redesigned
 //this method will be called by prepareToPlay and by processBlock each time an audio buffer needs to be processed
-//setStateInformation also calls this method to restore apvts settings from data stored in memory between loads of the plugin
+//a state restored by setStateInformation is picked up here as a full redesign
 void SimpleEQAudioProcessor::updateFilters(){
-    auto chainSettings = getChainSettings(apvts);
+    auto stereoSettings = getStereoSettings(apvts);
+    //a mono bus is filtered with lane 0 only, like linked L/R, whatever the stereo mode and link say
+    //the kernel reads both lanes of a sample before it writes either, so with left == right and identical lanes the
+    //channel is filtered once and the second lane of the pair is never seen
+    //a layout change always comes with prepareToPlay, which forces the full redesign below
+    if(getMainBusNumOutputChannels() < 2){
+        stereoSettings.mode = Stereo_LeftRight;
+        stereoSettings.linked = true;
+        stereoSettings.lanes[1] = stereoSettings.lanes[0];
+    }
+    auto fullRedesign = redesignPending.exchange(false) || designedSampleRate != getSampleRate();
+    //toggling crossover mode changes which slots the main output runs, so the GUI needs a new snapshot as well
+    auto publish = fullRedesign || stereoSettings.crossover != designedSettings.crossover;
     
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    if(fullRedesign || bandChanged(stereoSettings, designedSettings, sameLowCut)){
+        updateLowCutFilters(stereoSettings);
+        publish = true;
+    }
+    if(fullRedesign || bandChanged(stereoSettings, designedSettings, samePeak)){
+        updatePeakFilter(stereoSettings);
+        publish = true;
+    }
+    if(fullRedesign || bandChanged(stereoSettings, designedSettings, sameHighCut)){
+        updateHighCutFilters(stereoSettings);
+        publish = true;
+    }
+    
+    //the splits only follow lane 0
+    const auto& splits = stereoSettings.lanes[0];
+    const auto& designedSplits = designedSettings.lanes[0];
+    auto splitsChanged = splits.lowCutFreq != designedSplits.lowCutFreq || splits.highCutFreq != designedSplits.highCutFreq;
+    if(stereoSettings.crossover && (fullRedesign || ! designedSettings.crossover || splitsChanged)){
+        //switching into crossover mode starts the split from silence
+        if(! designedSettings.crossover){
+            crossover.reset();
+        }
+        updateCrossover(stereoSettings);
+    }
+    
+    setActiveSlots(cascade, stereoSettings, false);
+    designedSettings = stereoSettings;
+    designedSampleRate = getSampleRate();
+    
+    if(publish){
+        publishCoefficients();
+    }
+}
+
+//runs on whichever thread called updateFilters, normally the audio thread, and only copies
+void SimpleEQAudioProcessor::publishCoefficients(){
+    auto& snapshot = coefficientSnapshots.getWriteSlot();
+    snapshot.version = coefficientVersion.load(std::memory_order_relaxed) + 1;
+    snapshot.sampleRate = designedSampleRate;
+    snapshot.settings = designedSettings;
+    snapshot.cascade = cascade;
+    setActiveSlots(snapshot.cascade, designedSettings, true);
+    coefficientSnapshots.publish();
+    coefficientVersion.store(snapshot.version);
 }
 
 //method to create parameter layout variable to be passed to apvts
@@ -306,32 +679,6 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
     
-    //paramID: LowCut Freq, paramName: LowCut Freq
-    //normalisable range: 20 Hz to 20000 Hz, step size: 1 (deals with how much each turn of the knob changes the value),
-    //skew factor: 1 (percentage of knob reserved for a given range), default value: 20 Hz
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("LowCut Freq", 1),
-                                                           "LowCut Freq",
-                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                           20.f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("HighCut Freq", 1),
-                                                           "HighCut Freq",
-                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                           20000.f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Peak Freq", 1),
-                                                           "Peak Freq",
-                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                           750.f));
-    //gain measured in dB from -24 to 24 dB
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Peak Gain", 1),
-                                                           "Peak Gain",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Peak Quality", 1),
-                                                           "Peak Quality",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                           1.f));
     //setting up string array for adjusting slope on LC, HC band
     juce::StringArray stringArray;
     for(int i = 0; i < 4; i++){
@@ -340,10 +687,64 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
         str << " db/Oct";
         stringArray.add(str);
     }
-    //LC and HC slope choice paramters
-    //param id: LowCut Slope, param name: LowCut Slope, choice stringArray: stringArray, default index: 0
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("LowCut Slope", 1), "LowCut Slope", stringArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("HighCut Slope", 1), "HighCut Slope", stringArray, 0));
+    
+    //lane 0 keeps the original IDs so existing sessions still load
+    //lane 1 is the right channel set when unlinked, or the side set in M/S mode
+    for(int lane = 0; lane < 2; ++lane){
+        auto id = [lane](const juce::String& name){ return juce::ParameterID(getParamID(name, lane), 1); };
+        auto name = [lane](const juce::String& label){ return lane == 0 ? label : label + " (Right/Side)"; };
+        
+        //paramID: LowCut Freq, paramName: LowCut Freq
+        //normalisable range: 20 Hz to 20000 Hz, step size: 1 (deals with how much each turn of the knob changes the value),
+        //skew factor: 1 (percentage of knob reserved for a given range), default value: 20 Hz
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("LowCut Freq"),
+                                                               name("LowCut Freq"),
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                               20.f));
+        
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("HighCut Freq"),
+                                                               name("HighCut Freq"),
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                               20000.f));
+        
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Freq"),
+                                                               name("Peak Freq"),
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                               750.f));
+        //gain measured in dB from -24 to 24 dB
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Gain"),
+                                                               name("Peak Gain"),
+                                                               juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                               0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Quality"),
+                                                               name("Peak Quality"),
+                                                               juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                               1.f));
+        //LC and HC slope choice paramters
+        //param id: LowCut Slope, param name: LowCut Slope, choice stringArray: stringArray, default index: 0
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("LowCut Slope"), name("LowCut Slope"), stringArray, 0));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("HighCut Slope"), name("HighCut Slope"), stringArray, 0));
+    }
+    
+    //stereo mode choice parameter, index matches the StereoMode enum
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Stereo Mode", 1),
+                                                            "Stereo Mode",
+                                                            juce::StringArray{"Left/Right", "Mid/Side"},
+                                                            0));
+    
+    //linked channels share lane 0's settings in L/R mode, unlinking gives the right channel its own parameter set
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("Link Channels", 1), "Link Channels", true));
+    
+    //crossover mode splits into low/mid/high at the LC and HC frequencies and sends each band to its own output bus
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("Crossover", 1), "Crossover", false));
+    
+    //order of the filter stages, index matches the StageOrder enum
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Stage Order", 1),
+                                                            "Stage Order",
+                                                            juce::StringArray{"LowCut > Peak > HighCut",
+                                                                              "Peak > LowCut > HighCut",
+                                                                              "LowCut > HighCut > Peak"},
+                                                            0));
     
     return layout;
 }
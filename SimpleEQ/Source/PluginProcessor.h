@@ -10,105 +10,78 @@
 
 #include <JuceHeader.h>
 
+#include "StereoDesign.h"
+#include "Crossover.h"
+#include "ProcessingGraph.h"
+
+#include "SampleRing.h"
+#include "Metering.h"
+#include "TripleBuffer.h"
+
 #include <array>
-//FIFO for GUI thread to retrieve blocks produced by single channel sample FIFO
-template<typename T>
-struct Fifo{
-    void prepared(int numChannels, int numSamples){
-        for(auto& buffer : buffers){
-            buffer.setSize(numChannels,
-                           numSamples,
-                           false, //clear everything?
-                           true, //including the extra space?
-                           true); //avoid reallocating if possible
-            buffer.clear();
-        }
-    }
-    bool push(const T& t){
-        auto write = fifo.write(1);
-        if(write.blockSize1 > 0){
-            buffers[write.startIndex1] = t;
-            return true;
-        }
-        return false;
-    }
-    bool pull(const T& t){
-        auto read = fifo.read(1);
-        if(read.blockSize1 > 0){
-            t = buffers[read.startIndex1];
-            return true;
-        }
-        return false;
-    }
-    int getNumAvailableForReading() const{
-        return fifo.getNumReady();
-    }
-private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo {Capacity};
-};
 
+//buffer index of each channel, JUCE puts left at 0 and right at 1
 enum Channel{
-    Right, //effectively 0
-    Left //effectively 1
+    Left, //effectively 0
+    Right //effectively 1
 };
 
 //FFT algorithm which will allow for generation of spectral analyzer requires a fix number of samples passed into it
 //at any time. Because the audioBuffer can hold any number of samples at a given time, we must extract audio samples from
 //each indivudal channel at a fixed rate to pass them to the FFT algorithm for processing
+//samples go into one contiguous ring so a whole block is appended with a memcpy and the GUI reads frames in place
 template<typename BlockType>
 struct SingleChannelSampleFifo{
     SingleChannelSampleFifo(Channel ch) : channelToUse(ch){
         prepared.set(false);
     }
     
-    void update(const BlockType& buffer){
+    //returns false if the block was dropped because the reader fell behind
+    //a mono layout feeds both channels' FIFOs from channel 0, like processBlock runs it through both lanes
+    bool update(const BlockType& buffer){
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse);
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
-        for (int i = 0; i < buffer.getNumSamples(); ++i){
-            pushNextSampleIntoFifo(channelPtr[i]);
+        auto channel = juce::jmin(static_cast<int>(channelToUse), buffer.getNumChannels() - 1);
+        if(channel < 0){
+            return false;
         }
+        return ring.push(buffer.getReadPointer(channel), buffer.getNumSamples());
     }
     
-    void prepare(int bufferSize){
+    //frames have a fixed length unrelated to the host block size, so the analyzer sees the same frame size
+    //(and can pick its own FFT size and hop) whether the DAW runs 64 or 4096 sample buffers
+    void prepare(){
         prepared.set(false);
-        size.set(bufferSize);
-        
-        bufferToFill.setSize(1, //channel
-                             bufferSize, //num samples
-                             false, //keepExistingContent
-                             true, //clear extra space
-                             true); //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
+        size.set(FrameSize);
+        ring.prepare(FrameSize, NumFrames);
         prepared.set(true);
     }
     
-    int getNumCompleteBuffersAvailable() const {return audioBufferFifo.getNumAvailableForReading();}
+    //gives the ring memory back while nobody is capturing
+    void release(){
+        prepared.set(false);
+        ring.release();
+    }
+    
+    int getNumCompleteBuffersAvailable() const {return ring.getNumFramesAvailable();}
     bool isPrepared() const {return prepared.get();}
     int getSize() const {return size.get();}
-    bool getAudioBuffer(BlockType& buf){return audioBufferFifo.pull(buf);}
+    
+    //zero copy view of the oldest complete frame, valid until releaseFrame()
+    SampleSpan peekFrame() const {return ring.peekFrame();}
+    void releaseFrame() {ring.releaseFrame();}
+    
+    //samples dropped because the GUI did not keep up
+    juce::uint64 getNumOverflowedSamples() const {return ring.getNumOverflowedSamples();}
+    //every analyzer hop size is a whole number of frames
+    static constexpr int FrameSize = 256;
 private:
+    //room for the largest FFT plus enough slack for the analyzer thread to fall a few hops behind
+    static constexpr int NumFrames = 128;
+    
     Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
+    SampleRing ring;
     juce::Atomic<bool> prepared = false;
     juce::Atomic<int> size = 0;
-    
-    void pushNextSampleIntoFifo(float sample){
-        if (fifoIndex == bufferToFill.getNumSamples()){
-            auto ok = audioBufferFifo.push(bufferToFill);
-            
-            juce::ignoreUnused(ok);
-            fifoIndex = 0;
-        }
-        
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
 };
 
 enum Slope{
@@ -118,7 +91,21 @@ enum Slope{
     Slope_48
 };
 
+//L/R runs both channels through their own lane as before
+//M/S encodes to mid and side before the first filter and decodes after the last one
+enum StereoMode{
+    Stereo_LeftRight,
+    Stereo_MidSide
+};
+
 //struct for storing all paramters values from apvts
+//order of the filter stages in the processing graph, index matches the "Stage Order" choices
+enum StageOrder{
+    Order_LowCutPeakHighCut,
+    Order_PeakLowCutHighCut,
+    Order_LowCutHighCutPeak
+};
+
 struct ChainSettings
 {
     float peakFreq { 0 }, peakGainInDecibels { 0 }, peakQuality { 1.f };
@@ -126,84 +113,72 @@ struct ChainSettings
     Slope lowCutSlope { Slope::Slope_12 }, highCutSlope { Slope::Slope_12 };
 };
 
-using Filter = juce::dsp::IIR::Filter<float>;
+//filter settings for each lane of the stereo kernel
+//lane 0 (Left/Mid) uses the original parameter set, lane 1 (Right/Side) uses the second parameter set
+//when linked, lane 1 is a copy of lane 0 and its coefficients are designed only once
+struct StereoSettings
+{
+    StereoMode mode { Stereo_LeftRight };
+    bool linked { true };
+    //in crossover mode the cut frequencies become Linkwitz-Riley split points instead of cut filters
+    bool crossover { false };
+    std::array<ChainSettings, 2> lanes;
+    
+    int getNumDesignLanes() const { return linked ? 1 : 2; }
+};
 
-//each filter type in IIR filter class has response 12 dB/Oct when configured as Low Pass or High Pass
-//for response of 48 dB/Oct need 4 filters chained together with ProcessorChain and then pass a ProcessingContext
-//which will run through each Filter automatically
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+//copy of the cascade as last designed by the processor, handed to the GUI so the response curve shows exactly what
+//is being processed without designing anything itself
+//version goes up by one with every redesign, in crossover mode the cut slots are published inactive as the main
+//output does not run them
+struct CoefficientSnapshot{
+    juce::uint64 version { 0 };
+    double sampleRate { 0.0 };
+    StereoSettings settings;
+    StereoCascade cascade;
+};
 
-//defining a chain for mono signal path Low Cut -> Parametric -> High Cut
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-//need 2 monochains in order to do stereo processing
+//parameter IDs of the second (side) set are the original IDs with " 2" appended
+juce::String getParamID(const juce::String& name, int lane);
 
-enum ChainPositions{
-    LowCut,
-    Peak,
-    HighCut
+//display only settings of the editor, kept as properties of apvts.state rather than as parameters, so they are saved
+//with the session without hosts offering them for automation
+//only the message thread reads or writes them, nothing on the audio or analyzer threads depends on them
+enum ViewSetting{
+    View_FFTSize,
+    View_Overlap,
+    View_AnalyzerChannels,
+    View_AnalyzerPreEQ,
+    View_Smoothing,
+    View_CurveOverlay,
+    NumViewSettings
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(const Coefficients& old, const Coefficients& replacements);
-
-Coefficients makePeakFilter(const ChainSettings &chainSettings, double sampleRate);
-
-template<int Index, typename ChainType, typename CoefficientsType>
-void update(ChainType& chain, const CoefficientsType& coefficients){
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-//each time HC and LC mono chains need to be updateds this will be called
-//this method taks a reference to the given mono chain, the new coefficients, and the new slope
-//each link of a given chain is initially bypassed
-//but is reactivated based on the filter slope and given its new coefficients
-template<typename ChainType, typename CoefficientsType>
-void updateCutFilter(ChainType& chain,
-                     const CoefficientsType& coefficients,
-                     const Slope slope){
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
-    
-    //after getting array of coefficient filters
-    //filters in chain can be set based on what slope value and cut coefficient values are selected and filters can be de-bypassed
-    //can leverage case passthrough and a templated helper to eliminate code duplication
-    switch(slope){
-        case Slope_48:
-        {
-            update<3>(chain, coefficients);
-        }
-        case Slope_36:
-        {
-            update<2>(chain, coefficients);
-        }
-        case Slope_24:
-        {
-            update<1>(chain, coefficients);
-        }
-        case Slope_12:
-        {
-            update<0>(chain, coefficients);
-        }
-        
-    }
-}
+//property name, choices (as shown in the editor) and default choice of a view setting
+struct ViewSettingInfo{
+    juce::Identifier property;
+    juce::StringArray choices;
+    int defaultChoice;
+};
+
+const ViewSettingInfo& getViewSettingInfo(ViewSetting setting);
+//choice index stored in the state, the default if it is missing or out of range
+int getViewChoice(const juce::ValueTree& state, ViewSetting setting);
+void setViewChoice(juce::ValueTree& state, ViewSetting setting, int choice);
 
-inline auto makeLowCutFilter(const ChainSettings &chainSettings, double sampleRate){
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-                                                                                       sampleRate,
-                                                                                       (chainSettings.lowCutSlope + 1) * 2);
-}
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, int lane = 0);
+StereoSettings getStereoSettings(juce::AudioProcessorValueTreeState& apvts);
+//true if every setting of both lanes and the mode flags match
+bool sameSettings(const StereoSettings& a, const StereoSettings& b);
 
-inline auto makeHighCutFilter(const ChainSettings &chainSettings, double sampleRate){
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-                                                                                      sampleRate,
-                                                                                      (chainSettings.highCutSlope + 1) * 2);
-}
+//designs every section and active flag of a cascade for the settings the way updateFilters does band by band, with
+//the cut slots inactive in crossover mode like the published snapshots
+//the curve worker uses it when the processor has not published coefficients for the current parameters, which is
+//the case whenever the host is not calling processBlock
+void designCascade(StereoCascade& cascade, const StereoSettings& settings, double sampleRate);
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+//builds the processing graph from the stage order, stereo mode and crossover parameters
+GraphDescription getGraphDescription(juce::AudioProcessorValueTreeState& apvts);
 
 //==============================================================================
 /**
@@ -212,6 +187,8 @@ class SimpleEQAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::AudioProcessorValueTreeState::Listener
+                             , private juce::Timer
 {
 public:
     //==============================================================================
@@ -258,19 +235,88 @@ public:
     using BlockType = juce::AudioBuffer<float>;
     SingleChannelSampleFifo<BlockType> leftChannelFifo {Channel::Left};
     SingleChannelSampleFifo<BlockType> rightChannelFifo {Channel::Right};
+    //same channels captured before the schedule runs, for the pre EQ analyzer traces
+    SingleChannelSampleFifo<BlockType> leftPreFifo {Channel::Left};
+    SingleChannelSampleFifo<BlockType> rightPreFifo {Channel::Right};
+    
+    //message thread: each analyzer registers while it exists, the channel FIFOs are only allocated and filled
+    //while at least one is registered, so instances without an open editor skip capture entirely
+    void addAnalyzerSubscriber();
+    void removeAnalyzerSubscriber();
+    
+    //latest post EQ levels, lock free from any thread, only updated while an analyzer is subscribed
+    MeterSnapshot getMeterSnapshot() const { return meter.getSnapshot(); }
+    
+    //version of the newest published coefficients, polled by the editor to know when the curve is out of date
+    juce::uint64 getCoefficientVersion() const { return coefficientVersion.load(); }
+    
+    //instruction set the kernels run with, picked in prepareToPlay, the analyzer and the editor's workers build their
+    //kernels for the same level
+    IsaLevel getIsaLevel() const { return isaLevel.load(); }
+    //single reader, the response curve thread: takes the newest snapshot, returns false if nothing new was published
+    bool pullCoefficients() { return coefficientSnapshots.pull(); }
+    const CoefficientSnapshot& getCoefficients() const { return coefficientSnapshots.getReadSlot(); }
 private:
-    MonoChain leftChain, rightChain;
+    StereoMeter meter;
+    
+    //number of registered analyzers, written on the message thread and checked by processBlock
+    std::atomic<int> analyzerSubscribers { 0 };
+    //set by processBlock from the pre EQ FIFO writes to the post EQ ones, so the last subscriber can wait for
+    //writes in flight to finish before the FIFO memory is freed
+    std::atomic<bool> capturing { false };
+    
+    bool beginAnalyzerCapture();
+
+    //both channels run through one stereo cascade, each section holds separate coefficients for lane 0 and lane 1
+    StereoCascade cascade;
+    StereoCascadeState cascadeState;
+    
+    //instruction set level and the section kernel built for it, picked again in prepareToPlay
+    std::atomic<IsaLevel> isaLevel { selectIsaLevel() };
+    StereoSectionsKernel processSections { getStereoSectionsKernel(isaLevel.load()) };
+    
+    //low/mid/high split run by the Split op of the schedule in crossover mode
+    StereoCrossover crossover;
     
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    //schedule the audio thread runs, only touched by the audio thread once the constructor has compiled the first one
+    std::unique_ptr<ProcessingSchedule> activeSchedule;
+    //compiled by the timer and taken by the audio thread at the start of a block
+    std::atomic<ProcessingSchedule*> pendingSchedule { nullptr };
+    //schedule the audio thread swapped out, freed by the timer, a new one is only taken once this slot is empty
+    std::atomic<ProcessingSchedule*> retiredSchedule { nullptr };
+    //set by parameterChanged on whatever thread the host automates from, without posting a message
+    std::atomic<bool> graphChanged { false };
     
+    //audio thread, start of a block: swaps in a pending schedule, compiling it right there during an offline
+    //render so a bounce never runs the old topology
+    void pickUpSchedule();
     
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    //message thread: frees the retired schedule and compiles a changed graph
+    void timerCallback() override;
     
+    void runSchedule(const ProcessingSchedule& schedule, juce::AudioBuffer<float>& buffer, float* left, float* right);
     
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    //settings the cascade coefficients were last designed for, bands whose settings did not change are not redesigned
+    StereoSettings designedSettings;
+    double designedSampleRate { 0.0 };
+    //set by setStateInformation, the next updateFilters on the audio thread redesigns and publishes everything
+    std::atomic<bool> redesignPending { false };
+    
+    void updatePeakFilter(const StereoSettings& stereoSettings);
+    
+    void updateLowCutFilters(const StereoSettings& stereoSettings);
+    void updateHighCutFilters(const StereoSettings& stereoSettings);
+    void updateCrossover(const StereoSettings& stereoSettings);
     
     void updateFilters();
     
+    //written by updateFilters after every redesign, a fixed size copy so publishing never allocates
+    //updateFilters only runs on the audio thread (or in prepareToPlay), so this has a single writer
+    TripleBuffer<CoefficientSnapshot> coefficientSnapshots;
+    std::atomic<juce::uint64> coefficientVersion { 0 };
+    void publishCoefficients();
+    
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
 };
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    ProcessingGraph.cpp
+    User orderable description of the processing stages and the flat schedule it compiles into
+
+  ==============================================================================
+*/
+
+#include "ProcessingGraph.h"
+
+//cascade slots owned by each filter stage, in processing order
+static int getStageSlots(GraphStage stage, int* slots){
+    switch(stage){
+        case GraphStage::LowCut:
+            for(int i = 0; i < 4; ++i){
+                slots[i] = LowCutSlot + i;
+            }
+            return 4;
+        case GraphStage::Peak:
+            slots[0] = PeakSlot;
+            return 1;
+        case GraphStage::HighCut:
+            for(int i = 0; i < 4; ++i){
+                slots[i] = HighCutSlot + i;
+            }
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+std::unique_ptr<ProcessingSchedule> compileSchedule(const GraphDescription& graph){
+    auto schedule = std::make_unique<ProcessingSchedule>();
+    auto& ops = schedule->ops;
+    ops.reserve(graph.stages.size() + 1);
+
+    //op that filter stages are currently being merged into, -1 when the next stage has to start a new one
+    int openOp = -1;
+    bool inMidSide = false;
+    std::array<bool, MaxCascadeSlots> usedSlots {};
+
+    auto startOp = [&ops, &openOp](){
+        ops.push_back({});
+        openOp = static_cast<int>(ops.size()) - 1;
+        return openOp;
+    };
+
+    auto closeMidSide = [&](){
+        //decode fuses into the last stage of the open op, or becomes an op of its own if nothing is open
+        auto op = openOp >= 0 ? openOp : startOp();
+        ops[op].decodeMidSide = true;
+        openOp = -1;
+        inMidSide = false;
+    };
+
+    for(auto stage : graph.stages){
+        switch(stage){
+            case GraphStage::LowCut:
+            case GraphStage::Peak:
+            case GraphStage::HighCut:
+            {
+                std::array<int, 4> slots;
+                auto numSlots = getStageSlots(stage, slots.data());
+
+                //a stage owns its slots and their state, so it cannot run twice
+                if(usedSlots[slots[0]]){
+                    jassertfalse;
+                    break;
+                }
+
+                auto op = openOp >= 0 ? openOp : startOp();
+                for(int i = 0; i < numSlots; ++i){
+                    ops[op].slots[ops[op].numSlots++] = slots[i];
+                    usedSlots[slots[i]] = true;
+                }
+                break;
+            }
+            case GraphStage::MidSideEncode:
+            {
+                if(inMidSide){
+                    jassertfalse;
+                    break;
+                }
+                //encode fuses into the first stage of a fresh op
+                auto op = startOp();
+                ops[op].encodeMidSide = true;
+                inMidSide = true;
+                break;
+            }
+            case GraphStage::MidSideDecode:
+            {
+                if(! inMidSide){
+                    jassertfalse;
+                    break;
+                }
+                closeMidSide();
+                break;
+            }
+            case GraphStage::Crossover:
+            {
+                if(inMidSide){
+                    closeMidSide();
+                }
+                ScheduleOp split;
+                split.kind = ScheduleOp::Split;
+                ops.push_back(split);
+                return schedule;
+            }
+        }
+    }
+
+    if(inMidSide){
+        closeMidSide();
+    }
+
+    return schedule;
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    ProcessingGraph.h
+    User orderable description of the processing stages and the flat schedule it compiles into
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StereoKernel.h"
+
+#include <vector>
+#include <memory>
+
+//stages that can be placed in a graph
+//each filter stage owns fixed cascade slots (and their filter memory) so it can appear at most once
+enum class GraphStage{
+    LowCut,
+    Peak,
+    HighCut,
+    MidSideEncode,
+    MidSideDecode,
+    Crossover
+};
+
+//ordered list of stages, built from the parameters on the message thread, or on the audio thread during an
+//offline render
+struct GraphDescription{
+    std::vector<GraphStage> stages;
+};
+
+//one kernel call of a compiled schedule
+//Sections runs a list of cascade slots with M/S encode/decode fused into its first and last stage
+//Split runs the crossover and always ends the schedule
+struct ScheduleOp{
+    enum Kind{
+        Sections,
+        Split
+    };
+
+    Kind kind { Sections };
+    std::array<int, MaxCascadeSlots> slots {};
+    int numSlots = 0;
+    bool encodeMidSide = false, decodeMidSide = false;
+};
+
+//flat array of kernel calls, immutable once compiled so the audio thread can read it without locks
+struct ProcessingSchedule{
+    std::vector<ScheduleOp> ops;
+};
+
+//adjacent filter stages are merged into one Sections op, encode/decode are fused into the op next to them,
+//an encode without a matching decode is closed at the end of the schedule and stages after a crossover are dropped
+//allocates, so this must only be called off the audio thread unless the host renders offline
+std::unique_ptr<ProcessingSchedule> compileSchedule(const GraphDescription& graph);
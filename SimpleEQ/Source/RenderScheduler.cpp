@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    RenderScheduler.cpp
+    One frame clock for the editor that adapts its rate to activity and paint cost
+
+  ==============================================================================
+*/
+
+#include "RenderScheduler.h"
+
+#include <algorithm>
+
+RenderScheduler::Client::~Client(){
+    if(scheduler != nullptr){
+        scheduler->removeClient(*this);
+    }
+}
+
+RenderScheduler::Client::ScopedPaint::ScopedPaint(Client& client)
+    : scheduler(client.scheduler), start(juce::Time::getMillisecondCounterHiRes()){
+}
+
+RenderScheduler::Client::ScopedPaint::~ScopedPaint(){
+    if(scheduler != nullptr){
+        scheduler->paintFinished(juce::Time::getMillisecondCounterHiRes() - start);
+    }
+}
+
+RenderScheduler::RenderScheduler(){
+    lastChangeMs = juce::Time::getMillisecondCounterHiRes();
+    startTimer(getActiveIntervalMs());
+}
+
+RenderScheduler::~RenderScheduler(){
+    stopTimer();
+    for(auto* client : clients){
+        client->scheduler = nullptr;
+    }
+}
+
+void RenderScheduler::addClient(Client& client){
+    jassert(client.scheduler == nullptr);
+    client.scheduler = this;
+    clients.push_back(&client);
+}
+
+void RenderScheduler::removeClient(Client& client){
+    clients.erase(std::remove(clients.begin(), clients.end(), &client), clients.end());
+    client.scheduler = nullptr;
+}
+
+void RenderScheduler::wake(){
+    lastChangeMs = juce::Time::getMillisecondCounterHiRes();
+    if(getTimerInterval() != getActiveIntervalMs()){
+        startTimer(getActiveIntervalMs());
+    }
+}
+
+void RenderScheduler::paintFinished(double milliseconds){
+    paintMsThisFrame += milliseconds;
+    framePending = false;
+}
+
+//the frame interval that keeps painting within PaintBudget, between ActiveHz and MinActiveHz
+int RenderScheduler::getActiveIntervalMs() const{
+    auto interval = std::max(1000.0 / ActiveHz, averagePaintMs / PaintBudget);
+    return juce::roundToInt(std::min(interval, 1000.0 / MinActiveHz));
+}
+
+void RenderScheduler::timerCallback(){
+    auto now = juce::Time::getMillisecondCounterHiRes();
+
+    if(paintMsThisFrame > 0.0){
+        averagePaintMs += 0.2 * (paintMsThisFrame - averagePaintMs);
+        paintMsThisFrame = 0.0;
+    }
+
+    //the last frame is still waiting to be painted, asking for another would only queue work behind it
+    if(framePending && now - frameRequestedMs < StalledFrameMs){
+        return;
+    }
+    framePending = false;
+
+    auto changed = false;
+    for(auto* client : clients){
+        changed = client->renderFrame() || changed;
+    }
+
+    if(changed){
+        framePending = true;
+        frameRequestedMs = now;
+        lastChangeMs = now;
+    }
+
+    auto interval = now - lastChangeMs > IdleAfterMs ? 1000 / IdleHz : getActiveIntervalMs();
+    if(getTimerInterval() != interval){
+        startTimer(interval);
+    }
+}
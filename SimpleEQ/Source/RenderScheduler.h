@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    RenderScheduler.h
+    One frame clock for the editor that adapts its rate to activity and paint cost
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+//replaces a free running timer per component
+//every tick asks each client to pull its new data and repaint only the region that changed, then picks the next
+//interval: the active rate while anything changes, IdleHz once nothing has for IdleAfterMs, and never faster than
+//the measured paint cost allows, so an expensive frame lowers the rate instead of piling up repaints
+//a tick that comes while the previous frame has not been painted yet is skipped rather than queued
+class RenderScheduler : private juce::Timer{
+public:
+    struct Client{
+        virtual ~Client();
+
+        //message thread, once per tick: pull whatever is new, repaint the part of the component it affects and
+        //return true if anything changed, which keeps the scheduler at its active rate
+        virtual bool renderFrame() { return false; }
+
+    protected:
+        //times the paint() it is created in, so the scheduler knows what a frame costs
+        struct ScopedPaint{
+            explicit ScopedPaint(Client& client);
+            ~ScopedPaint();
+
+            RenderScheduler* scheduler;
+            double start;
+        };
+
+    private:
+        friend class RenderScheduler;
+        RenderScheduler* scheduler = nullptr;
+    };
+
+    RenderScheduler();
+    ~RenderScheduler() override;
+
+    void addClient(Client& client);
+    void removeClient(Client& client);
+
+    //message thread: something the clients poll is about to change (a knob moved), go back to the active rate now
+    //instead of waiting out an idle interval
+    void wake();
+
+    static constexpr int ActiveHz = 60;
+    static constexpr int MinActiveHz = 15;
+    static constexpr int IdleHz = 10;
+    static constexpr double IdleAfterMs = 1000.0;
+    //share of a frame interval painting may take before the rate is lowered
+    static constexpr double PaintBudget = 0.5;
+    //a frame that has not been painted after this long is given up on, the component may be hidden
+    static constexpr double StalledFrameMs = 250.0;
+
+private:
+    friend struct Client::ScopedPaint;
+
+    std::vector<Client*> clients;
+
+    //time of the last tick in which a client changed, or of the last wake()
+    double lastChangeMs = 0.0;
+    //a client repainted and no client has painted since
+    bool framePending = false;
+    double frameRequestedMs = 0.0;
+
+    //paint time since the last tick and its running average per frame
+    double paintMsThisFrame = 0.0;
+    double averagePaintMs = 0.0;
+
+    void timerCallback() override;
+    void paintFinished(double milliseconds);
+    int getActiveIntervalMs() const;
+};
@@ -0,0 +1,256 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+    Background thread turning the filter settings into a ready to stroke response curve
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+
+void CurveTrace::buildPath(juce::Path& path) const{
+    path.clear();
+    if(points.empty()){
+        return;
+    }
+    path.preallocateSpace(3 * static_cast<int>(points.size() + breaks.size()));
+    path.startNewSubPath(points.front());
+    auto nextBreak = breaks.begin();
+    for(size_t i = 1; i < points.size(); ++i){
+        if(nextBreak != breaks.end() && *nextBreak == i){
+            path.startNewSubPath(points[i]);
+            ++nextBreak;
+        }
+        else{
+            path.lineTo(points[i]);
+        }
+    }
+}
+
+ResponseCurveWorker::ResponseCurveWorker(SimpleEQAudioProcessor& p) : juce::Thread("Response Curve"), audioProcessor(p){
+}
+
+ResponseCurveWorker::~ResponseCurveWorker(){
+    stopThread(1000);
+}
+
+//component coordinates are far below 65536, each field is clamped to 16 bits to be sure
+void ResponseCurveWorker::setPlotArea(juce::Rectangle<int> area){
+    auto field = [](int value, int shift){
+        return static_cast<juce::uint64>(juce::jlimit(0, 0xffff, value)) << shift;
+    };
+    plotArea.store(field(area.getX(), 0) | field(area.getY(), 16) | field(area.getWidth(), 32) | field(area.getHeight(), 48));
+    requestUpdate();
+}
+
+void ResponseCurveWorker::requestUpdate(){
+    updateRequested.store(true);
+    notify();
+}
+
+void ResponseCurveWorker::setLane(int lane){
+    jassert(lane == 0 || lane == 1);
+    if(shownLane.exchange(lane) != lane){
+        requestUpdate();
+    }
+}
+
+void ResponseCurveWorker::run(){
+    while(! threadShouldExit()){
+        //requests that arrive while a curve is being built set the flag again and are picked up straight after
+        if(updateRequested.exchange(false)){
+            auto packed = plotArea.load();
+            auto field = [packed](int shift){ return static_cast<int>((packed >> shift) & 0xffff); };
+            juce::Rectangle<int> area(field(0), field(16), field(32), field(48));
+            audioProcessor.pullCoefficients();
+            const auto* coefficients = &audioProcessor.getCoefficients();
+
+            //the processor only publishes from prepareToPlay and processBlock, so while the host is not processing
+            //(stopped transport on some hosts, a suspended plugin, a standalone without a device) the parameters run
+            //ahead of the last snapshot, the curve then shows a design of its own until a matching one arrives
+            auto settings = getStereoSettings(audioProcessor.apvts);
+            auto sampleRate = audioProcessor.getSampleRate();
+            if(sampleRate > 0.0 && (coefficients->sampleRate != sampleRate
+                                    || ! sameSettings(coefficients->settings, settings))){
+                designedCoefficients.settings = settings;
+                designedCoefficients.sampleRate = sampleRate;
+                designCascade(designedCoefficients.cascade, settings, sampleRate);
+                coefficients = &designedCoefficients;
+            }
+
+            //nothing can be designed before the host has set a sample rate
+            if(area.getWidth() > 0 && coefficients->sampleRate > 0.0){
+                sectionResponse = getSectionResponseKernel(audioProcessor.getIsaLevel());
+                decibels = getDecibelsKernel(audioProcessor.getIsaLevel());
+                markChangedBands(*coefficients, shownLane.load());
+                evaluateBands(area, coefficients->sampleRate);
+                publishCurve(area);
+            }
+        }
+
+        wait(-1);
+    }
+}
+
+//a band is only evaluated again when one of its sections changed in the shown lane or its active flag changed
+//switching lanes evaluates every band again
+//snapshots the worker designed itself have no version, so the sections are always compared, which is nine sections
+void ResponseCurveWorker::markChangedBands(const CoefficientSnapshot& coefficients, int lane){
+    if(lane != evaluatedLane){
+        bandDirty.fill(true);
+    }
+    
+    auto index = static_cast<size_t>(lane);
+    auto sameSlots = [&](int first, int count){
+        for(int slot = first; slot < first + count; ++slot){
+            const auto& a = coefficients.cascade.sections[static_cast<size_t>(slot)];
+            const auto& b = evaluatedCascade.sections[static_cast<size_t>(slot)];
+            if(coefficients.cascade.active[static_cast<size_t>(slot)] != evaluatedCascade.active[static_cast<size_t>(slot)]
+               || a.b0[index] != b.b0[index] || a.b1[index] != b.b1[index] || a.b2[index] != b.b2[index]
+               || a.a1[index] != b.a1[index] || a.a2[index] != b.a2[index]){
+                return false;
+            }
+        }
+        return true;
+    };
+
+    bandDirty[Band_LowCut] = bandDirty[Band_LowCut] || ! sameSlots(LowCutSlot, 4);
+    bandDirty[Band_Peak] = bandDirty[Band_Peak] || ! sameSlots(PeakSlot, 1);
+    bandDirty[Band_HighCut] = bandDirty[Band_HighCut] || ! sameSlots(HighCutSlot, 4);
+
+    evaluatedCascade = coefficients.cascade;
+    evaluatedLane = lane;
+    evaluatedSettings = coefficients.settings.lanes[index];
+}
+
+void ResponseCurveWorker::evaluateBands(juce::Rectangle<int> area, double sampleRate){
+    using namespace juce;
+
+    auto width = area.getWidth();
+    auto height = static_cast<float>(area.getHeight());
+
+    //frequencies per pixel column only depend on the width, their trig table on the width and sample rate
+    if(static_cast<int>(frequencies.size()) != width || sampleRate != tableSampleRate || area.getHeight() != evaluatedHeight){
+        frequencies.resize(static_cast<size_t>(width));
+        for(int i = 0; i < width; ++i){
+            //mapping normalized magnitude to its frequency within human hearing range 20 Hz to 20000 Hz
+            frequencies[static_cast<size_t>(i)] = mapToLog10(double(i) / double(width), 20.0, 20000.0);
+        }
+        responseTable.build(frequencies, sampleRate);
+        tableSampleRate = sampleRate;
+        evaluatedHeight = area.getHeight();
+        bandDirty.fill(true);
+    }
+
+    //tolerances in the units of each trace, as publishCurve maps them
+    //cut bands never rise above 0 dB and the peak never above +24 dB, so a band below -48 dB cannot put the total on
+    //the -24 dB to +24 dB plot, differences below -54 dB are ignored and everything below -60 dB is one flat floor
+    sampler.setTrace(0, height / 48.f, 0.f, -54.f);
+    sampler.setTrace(1, height / MathConstants<float>::twoPi, MathConstants<float>::twoPi);
+    sampler.setTrace(2, height / (2.f * MaxGroupDelayMs) * static_cast<float>(1000.0 / sampleRate));
+
+    //column of a frequency on the log axis, the inverse of mapToLog10 above
+    auto columnOf = [width](float frequency){
+        return roundToInt(static_cast<float>(width) * std::log10(jmax(frequency, 1.f) / 20.f) / 3.f);
+    };
+
+    //sections of one band are gathered into a small array and evaluated in batches at the columns the sampler asks for,
+    //each batch gives the complex response and group delay together, magnitude and phase are read off the complex
+    //response and the sampler fills in the columns in between
+    auto evaluateBand = [&](CurveBand band, const StereoSection* sections, int numSections, float featureFrequency){
+        seeds.clear();
+        auto centre = columnOf(featureFrequency);
+        for(int offset = -12; offset <= 12; offset += 2){
+            seeds.push_back(centre + offset);
+        }
+
+        sampler.begin(width, 3, seeds);
+        while(! sampler.isDone()){
+            const auto& columns = sampler.getPendingColumns();
+            auto n = static_cast<int>(columns.size());
+            sampleTable.gather(responseTable, columns);
+            bandResponse.reset(n);
+            sectionResponse(sections, numSections, evaluatedLane, sampleTable, bandResponse);
+
+            bandPower.resize(columns.size());
+            sampleDecibels.resize(columns.size());
+            samplePhase.resize(columns.size());
+            computeResponsePowers(bandResponse, bandPower.data());
+            decibels(bandPower.data(), sampleDecibels.data(), n, 1.f, -60.f);
+            computeResponsePhases(bandResponse, samplePhase.data());
+            sampler.supply({sampleDecibels.data(), samplePhase.data(), bandResponse.groupDelay.data()});
+        }
+
+        auto columns = static_cast<size_t>(width);
+        bandDecibels[band].resize(columns);
+        bandPhase[band].resize(columns);
+        bandDelay[band].resize(columns);
+        sampler.reconstruct(0, bandDecibels[band].data());
+        sampler.reconstruct(1, bandPhase[band].data());
+        sampler.reconstruct(2, bandDelay[band].data());
+    };
+
+    //inactive slots are left out the same way the processor's schedule skips them
+    auto evaluateSlots = [&](CurveBand band, int first, int count, float featureFrequency){
+        std::array<StereoSection, 4> sections;
+        int numSections = 0;
+        for(int slot = first; slot < first + count; ++slot){
+            if(evaluatedCascade.active[static_cast<size_t>(slot)]){
+                sections[static_cast<size_t>(numSections++)] = evaluatedCascade.sections[static_cast<size_t>(slot)];
+            }
+        }
+        evaluateBand(band, sections.data(), numSections, featureFrequency);
+    };
+
+    if(bandDirty[Band_LowCut]){
+        evaluateSlots(Band_LowCut, LowCutSlot, 4, evaluatedSettings.lowCutFreq);
+    }
+    if(bandDirty[Band_Peak]){
+        evaluateSlots(Band_Peak, PeakSlot, 1, evaluatedSettings.peakFreq);
+    }
+    if(bandDirty[Band_HighCut]){
+        evaluateSlots(Band_HighCut, HighCutSlot, 4, evaluatedSettings.highCutFreq);
+    }
+    bandDirty.fill(false);
+}
+
+//sums the bands and maps them into the plot, the slot keeps its capacity so this only allocates on a resize
+//group delay is converted from samples to milliseconds, phase is wrapped back to -pi..pi after the sum
+//group delay goes negative around notches and steep boosts, so its scale is symmetric around 0 ms
+void ResponseCurveWorker::publishCurve(juce::Rectangle<int> area){
+    using namespace juce;
+
+    auto width = area.getWidth();
+    auto outputMin = static_cast<float>(area.getBottom());
+    auto outputMax = static_cast<float>(area.getY());
+    auto msPerSample = static_cast<float>(1000.0 / tableSampleRate);
+
+    auto& frame = frames.getWriteSlot();
+    for(auto* trace : {&frame.magnitude, &frame.phase, &frame.groupDelay}){
+        trace->points.resize(static_cast<size_t>(width));
+        trace->breaks.clear();
+    }
+
+    auto sum = [](const std::array<std::vector<float>, NumCurveBands>& bands, size_t i){
+        return bands[Band_LowCut][i] + bands[Band_Peak][i] + bands[Band_HighCut][i];
+    };
+
+    for(int i = 0; i < width; ++i){
+        auto index = static_cast<size_t>(i);
+        auto x = static_cast<float>(area.getX() + i);
+        //maps each dB unit to within the range we specified
+        frame.magnitude.points[index] = {x, jmap(sum(bandDecibels, index), -24.f, 24.f, outputMin, outputMax)};
+
+        auto phase = std::remainder(sum(bandPhase, index), MathConstants<float>::twoPi);
+        frame.phase.points[index] = {x, jmap(phase, -MathConstants<float>::pi, MathConstants<float>::pi, outputMin, outputMax)};
+        //a jump of more than half a turn between neighbouring columns is the wrap, not the filter
+        if(i > 0 && std::abs(frame.phase.points[index].y - frame.phase.points[index - 1].y) > 0.5f * (outputMin - outputMax)){
+            frame.phase.breaks.push_back(index);
+        }
+
+        auto delay = jlimit(-MaxGroupDelayMs, MaxGroupDelayMs, sum(bandDelay, index) * msPerSample);
+        frame.groupDelay.points[index] = {x, jmap(delay, -MaxGroupDelayMs, MaxGroupDelayMs, outputMin, outputMax)};
+    }
+    frames.publish();
+}
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+    Background thread turning the filter settings into a ready to stroke response curve
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "PluginProcessor.h"
+#include "ResponseEvaluator.h"
+#include "SpectrumMath.h"
+#include "CurveSampler.h"
+#include "TripleBuffer.h"
+
+#include <array>
+#include <vector>
+
+//one polyline in component coordinates, split into sub paths where a wrapped value jumps across the plot
+struct CurveTrace{
+    std::vector<juce::Point<float>> points;
+    //indices of the points that start a new sub path, besides the first one
+    std::vector<size_t> breaks;
+
+    //clears path and refills it with the trace
+    void buildPath(juce::Path& path) const;
+};
+
+//curves ready to be drawn, one point per pixel column of the plot
+//magnitude spans -24 dB to +24 dB, phase -180 to +180 degrees and group delay -MaxGroupDelayMs to +MaxGroupDelayMs,
+//bottom to top
+struct CurveFrame{
+    CurveTrace magnitude, phase, groupDelay;
+};
+
+//the message thread only asks for an update and strokes whatever was published last, all response evaluation
+//happens here on the coefficients the processor published, only while the host is not processing and the
+//parameters have moved past the last snapshot does the worker design them itself
+//the curve shows one lane, the one the editor's lane buttons show (Left/Mid or Right/Side)
+//the worker sleeps until requestUpdate() and then evaluates only the bands whose coefficients changed in that lane,
+//the per band responses are kept in decibels, radians and samples so the totals are their sums
+//each band is only evaluated at the columns its CurveSampler asks for, densely around the band's centre or corner
+//frequency and sparsely where it is flat, and filled in with a monotone cubic to within a quarter pixel per trace
+class ResponseCurveWorker : public juce::Thread{
+public:
+    static constexpr float MaxGroupDelayMs = 50.f;
+
+    ResponseCurveWorker(SimpleEQAudioProcessor& p);
+    ~ResponseCurveWorker() override;
+
+    //message thread: plot rectangle the points are mapped into
+    void setPlotArea(juce::Rectangle<int> area);
+    //message thread: the processor published new coefficients
+    void requestUpdate();
+    //message thread: lane of the cascade the curve shows, 0 or 1, every band is evaluated again when it changes
+    void setLane(int lane);
+
+    //message thread: takes the newest published curve, returns false if nothing new arrived since the last call
+    bool pullLatest() { return frames.pull(); }
+    const CurveFrame& getLatest() const { return frames.getReadSlot(); }
+
+    void run() override;
+
+private:
+    SimpleEQAudioProcessor& audioProcessor;
+
+    std::atomic<bool> updateRequested { true };
+    //plot rectangle packed as four 16 bit fields, so the worker never reads half of a resize
+    std::atomic<juce::uint64> plotArea { 0 };
+    std::atomic<int> shownLane { 0 };
+
+    TripleBuffer<CurveFrame> frames;
+
+    //everything below is only touched by the worker
+
+    //per band magnitude, phase and group delay at each pixel column
+    enum CurveBand{
+        Band_LowCut,
+        Band_Peak,
+        Band_HighCut,
+        NumCurveBands
+    };
+    std::array<std::vector<float>, NumCurveBands> bandDecibels, bandPhase, bandDelay;
+    std::array<bool, NumCurveBands> bandDirty {true, true, true};
+    //frequency of each pixel column and its cos/sin table, rebuilt when the width or sample rate changes
+    std::vector<double> frequencies;
+    ResponseTable responseTable;
+    //columns of responseTable a sampling round evaluates
+    ResponseTable sampleTable;
+    CurveSampler sampler;
+    //scratch for the complex response, linear power, decibels and phase at the sampled columns of one band
+    ResponseColumns bandResponse;
+    std::vector<float> bandPower, sampleDecibels, samplePhase;
+    std::vector<int> seeds;
+    //kernels for the processor's instruction set level, fetched again for every curve
+    SectionResponseKernel sectionResponse { accumulateSectionResponse };
+    DecibelsKernel decibels { powersToDecibels };
+    //cascade, lane and that lane's settings the band curves were last evaluated for, the settings place the seeds
+    StereoCascade evaluatedCascade;
+    int evaluatedLane { 0 };
+    ChainSettings evaluatedSettings;
+    //design of the current parameters, used while the processor has not published one for them
+    CoefficientSnapshot designedCoefficients;
+    double tableSampleRate { 0.0 };
+    //the sampling tolerance is in pixels, so a new plot height needs every band sampled again
+    int evaluatedHeight { 0 };
+
+    void markChangedBands(const CoefficientSnapshot& coefficients, int lane);
+    void evaluateBands(juce::Rectangle<int> area, double sampleRate);
+    void publishCurve(juce::Rectangle<int> area);
+
+    JUCE_DECLARE_NON_COPYABLE(ResponseCurveWorker)
+};
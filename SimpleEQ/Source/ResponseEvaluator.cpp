@@ -0,0 +1,385 @@
+/*
+  ==============================================================================
+
+    ResponseEvaluator.cpp
+    Batched complex response and group delay of biquad sections over precomputed frequency tables
+
+  ==============================================================================
+*/
+
+#include "ResponseEvaluator.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+#if JUCE_ARM && defined(__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+//keeps the numerator group delay finite at a zero on the unit circle, where the phase jumps anyway
+static constexpr float MinPower = 1.0e-20f;
+
+void ResponseTable::build(const std::vector<double>& frequencies, double sampleRate){
+    auto n = frequencies.size();
+    vers1.resize(n);
+    sin1.resize(n);
+    vers2.resize(n);
+    sin2.resize(n);
+
+    for(size_t i = 0; i < n; ++i){
+        auto w = juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate;
+        //1 - cos x = 2 sin^2(x / 2) without the cancellation
+        auto halfSin = std::sin(0.5 * w);
+        auto sin = std::sin(w);
+        vers1[i] = static_cast<float>(2.0 * halfSin * halfSin);
+        sin1[i] = static_cast<float>(sin);
+        vers2[i] = static_cast<float>(2.0 * sin * sin);
+        sin2[i] = static_cast<float>(std::sin(2.0 * w));
+    }
+}
+
+void ResponseTable::gather(const ResponseTable& source, const std::vector<int>& columns){
+    auto n = columns.size();
+    vers1.resize(n);
+    sin1.resize(n);
+    vers2.resize(n);
+    sin2.resize(n);
+
+    for(size_t i = 0; i < n; ++i){
+        auto column = static_cast<size_t>(columns[i]);
+        vers1[i] = source.vers1[column];
+        sin1[i] = source.sin1[column];
+        vers2[i] = source.vers2[column];
+        sin2[i] = source.sin2[column];
+    }
+}
+
+void ResponseColumns::reset(int numColumns){
+    auto n = static_cast<size_t>(numColumns);
+    re.assign(n, 1.f);
+    im.assign(n, 0.f);
+    groupDelay.assign(n, 0.f);
+}
+
+//the imaginary parts below are kept with their sign flipped, x1 sin w + x2 sin 2w instead of -(x1 sin w + x2 sin 2w),
+//which leaves every product of two of them unchanged and only turns the section's imaginary part into
+//(nRe dIm - nIm dRe) / |D|^2
+
+//coefficient sums the real parts start from, x0 + x1 + x2 for the polynomials and x1 + 2 x2 for their derivatives
+struct SectionSums{
+    SectionSums(const StereoSection& section, size_t l)
+        : numerator(section.b0[l] + section.b1[l] + section.b2[l]),
+          denominator(1.f + section.a1[l] + section.a2[l]),
+          numeratorSlope(section.b1[l] + 2.f * section.b2[l]),
+          denominatorSlope(section.a1[l] + 2.f * section.a2[l]) {}
+
+    float numerator, denominator, numeratorSlope, denominatorSlope;
+};
+
+//one section at one column, the scalar reference for the vector loops
+//x0 + x1 cos w + x2 cos 2w is evaluated as (x0 + x1 + x2) - x1 (1 - cos w) - x2 (1 - cos 2w)
+static inline void sectionResponse(const StereoSection& section, const SectionSums& sums, size_t l,
+                                   float v1, float s1, float v2, float s2,
+                                   float& re, float& im, float& delay){
+    auto b1 = section.b1[l], b2 = section.b2[l], a1 = section.a1[l], a2 = section.a2[l];
+    auto nRe = sums.numerator - b1 * v1 - b2 * v2;
+    auto nIm = b1 * s1 + b2 * s2;
+    auto dRe = sums.denominator - a1 * v1 - a2 * v2;
+    auto dIm = a1 * s1 + a2 * s2;
+    auto qnRe = sums.numeratorSlope - b1 * v1 - 2.f * b2 * v2;
+    auto qnIm = b1 * s1 + 2.f * b2 * s2;
+    auto qdRe = sums.denominatorSlope - a1 * v1 - 2.f * a2 * v2;
+    auto qdIm = a1 * s1 + 2.f * a2 * s2;
+
+    auto nPower = std::max(nRe * nRe + nIm * nIm, MinPower);
+    auto dPower = dRe * dRe + dIm * dIm;
+    delay += (qnRe * nRe + qnIm * nIm) / nPower - (qdRe * dRe + qdIm * dIm) / dPower;
+
+    auto hRe = (nRe * dRe + nIm * dIm) / dPower;
+    auto hIm = (nRe * dIm - nIm * dRe) / dPower;
+    auto newRe = re * hRe - im * hIm;
+    im = re * hIm + im * hRe;
+    re = newRe;
+}
+
+//the scalar loop is the tail of every vector build, from the first column the vector loop left
+static void addSectionResponse(const StereoSection* sections, int numSections, size_t l, const ResponseTable& table,
+                               ResponseColumns& response, int i){
+    for(auto n = table.size(); i < n; ++i){
+        auto c = static_cast<size_t>(i);
+        for(int s = 0; s < numSections; ++s){
+            sectionResponse(sections[s], SectionSums(sections[s], l), l,
+                            table.vers1[c], table.sin1[c], table.vers2[c], table.sin2[c],
+                            response.re[c], response.im[c], response.groupDelay[c]);
+        }
+    }
+}
+
+static void accumulateSectionResponseScalar(const StereoSection* sections,
+                                            int numSections,
+                                            int lane,
+                                            const ResponseTable& table,
+                                            ResponseColumns& response){
+    jassert(response.size() == table.size());
+    addSectionResponse(sections, numSections, static_cast<size_t>(lane), table, response, 0);
+}
+
+#if JUCE_INTEL
+static void accumulateSectionResponseSSE2(const StereoSection* sections,
+                                          int numSections,
+                                          int lane,
+                                          const ResponseTable& table,
+                                          ResponseColumns& response){
+    auto n = table.size();
+    jassert(response.size() == n);
+    const auto* v1 = table.vers1.data();
+    const auto* s1 = table.sin1.data();
+    const auto* v2 = table.vers2.data();
+    const auto* s2 = table.sin2.data();
+    auto* re = response.re.data();
+    auto* im = response.im.data();
+    auto* delay = response.groupDelay.data();
+    auto l = static_cast<size_t>(lane);
+
+    int i = 0;
+    for(; i + 4 <= n; i += 4){
+        auto vv1 = _mm_loadu_ps(v1 + i), vs1 = _mm_loadu_ps(s1 + i);
+        auto vv2 = _mm_loadu_ps(v2 + i), vs2 = _mm_loadu_ps(s2 + i);
+        auto vre = _mm_loadu_ps(re + i), vim = _mm_loadu_ps(im + i), vdelay = _mm_loadu_ps(delay + i);
+
+        //x0 - x1 (1 - cos) - x2 (1 - cos2) for the real parts, x1 sin + x2 sin2 for the imaginary parts
+        auto real = [&](float x0, float x1, float x2){
+            return _mm_sub_ps(_mm_set1_ps(x0), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(x1), vv1), _mm_mul_ps(_mm_set1_ps(x2), vv2)));
+        };
+        auto imag = [&](float x1, float x2){
+            return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(x1), vs1), _mm_mul_ps(_mm_set1_ps(x2), vs2));
+        };
+
+        for(int s = 0; s < numSections; ++s){
+            const auto& section = sections[s];
+            SectionSums sums(section, l);
+            auto b1 = section.b1[l], b2 = section.b2[l], a1 = section.a1[l], a2 = section.a2[l];
+
+            auto nRe = real(sums.numerator, b1, b2);
+            auto nIm = imag(b1, b2);
+            auto dRe = real(sums.denominator, a1, a2);
+            auto dIm = imag(a1, a2);
+            auto qnRe = real(sums.numeratorSlope, b1, 2.f * b2);
+            auto qnIm = imag(b1, 2.f * b2);
+            auto qdRe = real(sums.denominatorSlope, a1, 2.f * a2);
+            auto qdIm = imag(a1, 2.f * a2);
+
+            auto nPower = _mm_max_ps(_mm_add_ps(_mm_mul_ps(nRe, nRe), _mm_mul_ps(nIm, nIm)), _mm_set1_ps(MinPower));
+            auto dPower = _mm_add_ps(_mm_mul_ps(dRe, dRe), _mm_mul_ps(dIm, dIm));
+            auto numeratorDelay = _mm_div_ps(_mm_add_ps(_mm_mul_ps(qnRe, nRe), _mm_mul_ps(qnIm, nIm)), nPower);
+            auto denominatorDelay = _mm_div_ps(_mm_add_ps(_mm_mul_ps(qdRe, dRe), _mm_mul_ps(qdIm, dIm)), dPower);
+            vdelay = _mm_add_ps(vdelay, _mm_sub_ps(numeratorDelay, denominatorDelay));
+
+            auto inverse = _mm_div_ps(_mm_set1_ps(1.f), dPower);
+            auto hRe = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(nRe, dRe), _mm_mul_ps(nIm, dIm)), inverse);
+            auto hIm = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(nRe, dIm), _mm_mul_ps(nIm, dRe)), inverse);
+            auto newRe = _mm_sub_ps(_mm_mul_ps(vre, hRe), _mm_mul_ps(vim, hIm));
+            vim = _mm_add_ps(_mm_mul_ps(vre, hIm), _mm_mul_ps(vim, hRe));
+            vre = newRe;
+        }
+        _mm_storeu_ps(re + i, vre);
+        _mm_storeu_ps(im + i, vim);
+        _mm_storeu_ps(delay + i, vdelay);
+    }
+
+    addSectionResponse(sections, numSections, l, table, response, i);
+}
+#endif
+
+#if SIMPLEEQ_AVX2
+//the real and imaginary parts of the SSE2 build as fused multiply-adds, functions rather than lambdas so they are
+//compiled for the same target
+SIMPLEEQ_TARGET_AVX2
+static inline __m256 realPartAVX2(__m256 vv1, __m256 vv2, float x0, float x1, float x2){
+    return _mm256_fnmadd_ps(_mm256_set1_ps(x2), vv2, _mm256_fnmadd_ps(_mm256_set1_ps(x1), vv1, _mm256_set1_ps(x0)));
+}
+
+SIMPLEEQ_TARGET_AVX2
+static inline __m256 imagPartAVX2(__m256 vs1, __m256 vs2, float x1, float x2){
+    return _mm256_fmadd_ps(_mm256_set1_ps(x2), vs2, _mm256_mul_ps(_mm256_set1_ps(x1), vs1));
+}
+
+//eight columns per step
+SIMPLEEQ_TARGET_AVX2
+static void accumulateSectionResponseAVX2(const StereoSection* sections,
+                                          int numSections,
+                                          int lane,
+                                          const ResponseTable& table,
+                                          ResponseColumns& response){
+    auto n = table.size();
+    jassert(response.size() == n);
+    const auto* v1 = table.vers1.data();
+    const auto* s1 = table.sin1.data();
+    const auto* v2 = table.vers2.data();
+    const auto* s2 = table.sin2.data();
+    auto* re = response.re.data();
+    auto* im = response.im.data();
+    auto* delay = response.groupDelay.data();
+    auto l = static_cast<size_t>(lane);
+
+    int i = 0;
+    for(; i + 8 <= n; i += 8){
+        auto vv1 = _mm256_loadu_ps(v1 + i), vs1 = _mm256_loadu_ps(s1 + i);
+        auto vv2 = _mm256_loadu_ps(v2 + i), vs2 = _mm256_loadu_ps(s2 + i);
+        auto vre = _mm256_loadu_ps(re + i), vim = _mm256_loadu_ps(im + i), vdelay = _mm256_loadu_ps(delay + i);
+
+        for(int s = 0; s < numSections; ++s){
+            const auto& section = sections[s];
+            SectionSums sums(section, l);
+            auto b1 = section.b1[l], b2 = section.b2[l], a1 = section.a1[l], a2 = section.a2[l];
+
+            auto nRe = realPartAVX2(vv1, vv2, sums.numerator, b1, b2);
+            auto nIm = imagPartAVX2(vs1, vs2, b1, b2);
+            auto dRe = realPartAVX2(vv1, vv2, sums.denominator, a1, a2);
+            auto dIm = imagPartAVX2(vs1, vs2, a1, a2);
+            auto qnRe = realPartAVX2(vv1, vv2, sums.numeratorSlope, b1, 2.f * b2);
+            auto qnIm = imagPartAVX2(vs1, vs2, b1, 2.f * b2);
+            auto qdRe = realPartAVX2(vv1, vv2, sums.denominatorSlope, a1, 2.f * a2);
+            auto qdIm = imagPartAVX2(vs1, vs2, a1, 2.f * a2);
+
+            auto nPower = _mm256_max_ps(_mm256_fmadd_ps(nIm, nIm, _mm256_mul_ps(nRe, nRe)), _mm256_set1_ps(MinPower));
+            auto dPower = _mm256_fmadd_ps(dIm, dIm, _mm256_mul_ps(dRe, dRe));
+            auto numeratorDelay = _mm256_div_ps(_mm256_fmadd_ps(qnIm, nIm, _mm256_mul_ps(qnRe, nRe)), nPower);
+            auto denominatorDelay = _mm256_div_ps(_mm256_fmadd_ps(qdIm, dIm, _mm256_mul_ps(qdRe, dRe)), dPower);
+            vdelay = _mm256_add_ps(vdelay, _mm256_sub_ps(numeratorDelay, denominatorDelay));
+
+            auto inverse = _mm256_div_ps(_mm256_set1_ps(1.f), dPower);
+            auto hRe = _mm256_mul_ps(_mm256_fmadd_ps(nIm, dIm, _mm256_mul_ps(nRe, dRe)), inverse);
+            auto hIm = _mm256_mul_ps(_mm256_fmsub_ps(nRe, dIm, _mm256_mul_ps(nIm, dRe)), inverse);
+            auto newRe = _mm256_fmsub_ps(vre, hRe, _mm256_mul_ps(vim, hIm));
+            vim = _mm256_fmadd_ps(vre, hIm, _mm256_mul_ps(vim, hRe));
+            vre = newRe;
+        }
+        _mm256_storeu_ps(re + i, vre);
+        _mm256_storeu_ps(im + i, vim);
+        _mm256_storeu_ps(delay + i, vdelay);
+    }
+
+    addSectionResponse(sections, numSections, l, table, response, i);
+}
+#endif
+
+#if JUCE_ARM && defined(__ARM_NEON)
+static void accumulateSectionResponseNEON(const StereoSection* sections,
+                                          int numSections,
+                                          int lane,
+                                          const ResponseTable& table,
+                                          ResponseColumns& response){
+    auto n = table.size();
+    jassert(response.size() == n);
+    const auto* v1 = table.vers1.data();
+    const auto* s1 = table.sin1.data();
+    const auto* v2 = table.vers2.data();
+    const auto* s2 = table.sin2.data();
+    auto* re = response.re.data();
+    auto* im = response.im.data();
+    auto* delay = response.groupDelay.data();
+    auto l = static_cast<size_t>(lane);
+
+    //reciprocal estimate plus two Newton steps, plenty for drawing
+    auto reciprocal = [](float32x4_t x){
+        auto r = vrecpeq_f32(x);
+        r = vmulq_f32(vrecpsq_f32(x, r), r);
+        return vmulq_f32(vrecpsq_f32(x, r), r);
+    };
+
+    int i = 0;
+    for(; i + 4 <= n; i += 4){
+        auto vv1 = vld1q_f32(v1 + i), vs1 = vld1q_f32(s1 + i);
+        auto vv2 = vld1q_f32(v2 + i), vs2 = vld1q_f32(s2 + i);
+        auto vre = vld1q_f32(re + i), vim = vld1q_f32(im + i), vdelay = vld1q_f32(delay + i);
+
+        auto real = [&](float x0, float x1, float x2){
+            return vmlsq_n_f32(vmlsq_n_f32(vdupq_n_f32(x0), vv1, x1), vv2, x2);
+        };
+        auto imag = [&](float x1, float x2){
+            return vmlaq_n_f32(vmulq_n_f32(vs1, x1), vs2, x2);
+        };
+
+        for(int s = 0; s < numSections; ++s){
+            const auto& section = sections[s];
+            SectionSums sums(section, l);
+            auto b1 = section.b1[l], b2 = section.b2[l], a1 = section.a1[l], a2 = section.a2[l];
+
+            auto nRe = real(sums.numerator, b1, b2);
+            auto nIm = imag(b1, b2);
+            auto dRe = real(sums.denominator, a1, a2);
+            auto dIm = imag(a1, a2);
+            auto qnRe = real(sums.numeratorSlope, b1, 2.f * b2);
+            auto qnIm = imag(b1, 2.f * b2);
+            auto qdRe = real(sums.denominatorSlope, a1, 2.f * a2);
+            auto qdIm = imag(a1, 2.f * a2);
+
+            auto nPower = vmaxq_f32(vmlaq_f32(vmulq_f32(nRe, nRe), nIm, nIm), vdupq_n_f32(MinPower));
+            auto inverse = reciprocal(vmlaq_f32(vmulq_f32(dRe, dRe), dIm, dIm));
+            auto numeratorDelay = vmulq_f32(vmlaq_f32(vmulq_f32(qnRe, nRe), qnIm, nIm), reciprocal(nPower));
+            auto denominatorDelay = vmulq_f32(vmlaq_f32(vmulq_f32(qdRe, dRe), qdIm, dIm), inverse);
+            vdelay = vaddq_f32(vdelay, vsubq_f32(numeratorDelay, denominatorDelay));
+
+            auto hRe = vmulq_f32(vmlaq_f32(vmulq_f32(nRe, dRe), nIm, dIm), inverse);
+            auto hIm = vmulq_f32(vmlsq_f32(vmulq_f32(nRe, dIm), nIm, dRe), inverse);
+            auto newRe = vmlsq_f32(vmulq_f32(vre, hRe), vim, hIm);
+            vim = vmlaq_f32(vmulq_f32(vre, hIm), vim, hRe);
+            vre = newRe;
+        }
+        vst1q_f32(re + i, vre);
+        vst1q_f32(im + i, vim);
+        vst1q_f32(delay + i, vdelay);
+    }
+
+    addSectionResponse(sections, numSections, l, table, response, i);
+}
+#endif
+
+void accumulateSectionResponse(const StereoSection* sections,
+                               int numSections,
+                               int lane,
+                               const ResponseTable& table,
+                               ResponseColumns& response){
+   #if JUCE_INTEL
+    accumulateSectionResponseSSE2(sections, numSections, lane, table, response);
+   #elif JUCE_ARM && defined(__ARM_NEON)
+    accumulateSectionResponseNEON(sections, numSections, lane, table, response);
+   #else
+    accumulateSectionResponseScalar(sections, numSections, lane, table, response);
+   #endif
+}
+
+SectionResponseKernel getSectionResponseKernel(IsaLevel isa){
+    switch(isa){
+       #if JUCE_INTEL
+        case IsaLevel::SSE2:
+            return accumulateSectionResponseSSE2;
+       #endif
+       #if SIMPLEEQ_AVX2
+        case IsaLevel::AVX2:
+            return accumulateSectionResponseAVX2;
+       #endif
+       #if JUCE_ARM && defined(__ARM_NEON)
+        case IsaLevel::NEON:
+            return accumulateSectionResponseNEON;
+       #endif
+        default:
+            return accumulateSectionResponseScalar;
+    }
+}
+
+void computeResponsePowers(const ResponseColumns& response, float* power){
+    auto n = response.size();
+    juce::FloatVectorOperations::multiply(power, response.re.data(), response.re.data(), n);
+    for(int i = 0; i < n; ++i){
+        power[i] += response.im[static_cast<size_t>(i)] * response.im[static_cast<size_t>(i)];
+    }
+}
+
+void computeResponsePhases(const ResponseColumns& response, float* phase){
+    auto n = response.size();
+    for(int i = 0; i < n; ++i){
+        phase[i] = std::atan2(response.im[static_cast<size_t>(i)], response.re[static_cast<size_t>(i)]);
+    }
+}
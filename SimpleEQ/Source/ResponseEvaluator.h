@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    ResponseEvaluator.h
+    Batched complex response and group delay of biquad sections over precomputed frequency tables
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "StereoKernel.h"
+#include "CpuDispatch.h"
+
+#include <vector>
+
+//1 - cos and sin of w and 2w for every display column, w = 2 pi f / fs
+//only depends on the column frequencies and the sample rate, so it is built on resize or a sample rate change and
+//every evaluation after that is multiplies and adds
+//1 - cos is kept instead of cos because 1 + a1 cos w + a2 cos 2w cancels almost completely for poles near DC, written
+//as (1 + a1 + a2) - a1 (1 - cos w) - a2 (1 - cos 2w) the sum is exact in float and the small terms keep their precision
+//Tests/Source/ResponseEvaluatorTests.cpp holds this against a double precision reference for low cuts near DC
+struct ResponseTable{
+    void build(const std::vector<double>& frequencies, double sampleRate);
+    //copies the given columns of another table, for evaluating a subset of its columns
+    void gather(const ResponseTable& source, const std::vector<int>& columns);
+    int size() const { return static_cast<int>(vers1.size()); }
+
+    std::vector<float> vers1, sin1, vers2, sin2;
+};
+
+//response of a cascade at every column of a table, complex so sections can be multiplied in and the phase read off
+//re/im start at 1 + 0j and groupDelay (in samples) at 0, reset() does both
+struct ResponseColumns{
+    void reset(int numColumns);
+    int size() const { return static_cast<int>(re.size()); }
+
+    std::vector<float> re, im, groupDelay;
+};
+
+//multiplies each column of response by H(e^jw) of each section's given lane and adds the section's group delay
+//with H = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2) numerator, denominator and their derivatives are plain
+//dot products with the table, the group delay of a polynomial P being Re(P' conj(P)) / |P|^2 with
+//P' = x1 e^-jw + 2 x2 e^-2jw, so magnitude, phase and group delay all come out of one pass, four or eight columns
+//at a time
+void accumulateSectionResponse(const StereoSection* sections,
+                               int numSections,
+                               int lane,
+                               const ResponseTable& table,
+                               ResponseColumns& response);
+
+using SectionResponseKernel = void (*)(const StereoSection*, int, int, const ResponseTable&, ResponseColumns&);
+
+//accumulateSectionResponse built for the given instruction set, accumulateSectionResponse itself is the SSE2 build on
+//Intel and the NEON build on ARM, only pass levels isIsaSupported() accepts
+SectionResponseKernel getSectionResponseKernel(IsaLevel isa);
+
+//|H|^2 of every column, to be turned into decibels with powersToDecibels
+void computeResponsePowers(const ResponseColumns& response, float* power);
+
+//arg(H) of every column in radians, wrapped to -pi..pi
+void computeResponsePhases(const ResponseColumns& response, float* phase);
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    SampleRing.cpp
+    Lock-free single producer / single consumer ring of float samples
+
+  ==============================================================================
+*/
+
+#include "SampleRing.h"
+
+void SampleRing::prepare(int newFrameSize, int numFrames){
+    jassert(newFrameSize > 0 && numFrames > 0);
+
+    frameSize = newFrameSize;
+    capacity = newFrameSize * numFrames;
+    storage.assign(static_cast<size_t>(capacity), 0.f);
+
+    writePosition.store(0);
+    readPosition.store(0);
+    overflowedSamples.store(0);
+}
+
+void SampleRing::release(){
+    std::vector<float>().swap(storage);
+    capacity = 0;
+    frameSize = 0;
+
+    writePosition.store(0);
+    readPosition.store(0);
+}
+
+bool SampleRing::push(const float* samples, int numSamples){
+    //nothing to write into before prepare() or after release()
+    if(capacity == 0){
+        return false;
+    }
+
+    auto write = writePosition.load(std::memory_order_relaxed);
+    auto read = readPosition.load(std::memory_order_acquire);
+    auto free = static_cast<juce::uint64>(capacity) - (write - read);
+
+    if(static_cast<juce::uint64>(numSamples) > free){
+        overflowedSamples.fetch_add(static_cast<juce::uint64>(numSamples), std::memory_order_relaxed);
+        return false;
+    }
+
+    auto start = static_cast<int>(write % static_cast<juce::uint64>(capacity));
+    auto first = juce::jmin(numSamples, capacity - start);
+
+    std::memcpy(storage.data() + start, samples, sizeof(float) * static_cast<size_t>(first));
+    if(first < numSamples){
+        std::memcpy(storage.data(), samples + first, sizeof(float) * static_cast<size_t>(numSamples - first));
+    }
+
+    writePosition.store(write + static_cast<juce::uint64>(numSamples), std::memory_order_release);
+    return true;
+}
+
+int SampleRing::getNumFramesAvailable() const{
+    if(frameSize == 0){
+        return 0;
+    }
+    auto ready = writePosition.load(std::memory_order_acquire) - readPosition.load(std::memory_order_relaxed);
+    return static_cast<int>(ready / static_cast<juce::uint64>(frameSize));
+}
+
+SampleSpan SampleRing::peekFrame() const{
+    if(getNumFramesAvailable() == 0){
+        return {};
+    }
+    auto start = static_cast<int>(readPosition.load(std::memory_order_relaxed) % static_cast<juce::uint64>(capacity));
+    return {storage.data() + start, frameSize};
+}
+
+void SampleRing::releaseFrame(){
+    jassert(getNumFramesAvailable() > 0);
+    readPosition.store(readPosition.load(std::memory_order_relaxed) + static_cast<juce::uint64>(frameSize),
+                       std::memory_order_release);
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    SampleRing.h
+    Lock-free single producer / single consumer ring of float samples
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <vector>
+
+//non-owning view of a contiguous run of samples
+struct SampleSpan{
+    const float* data = nullptr;
+    int size = 0;
+
+    bool empty() const { return size == 0; }
+    const float* begin() const { return data; }
+    const float* end() const { return data + size; }
+    float operator[](int i) const { return data[i]; }
+};
+
+//the audio thread appends whole blocks with one memcpy, or two when the block wraps around the end of the storage
+//the reader takes fixed size frames, and because the capacity is a whole number of frames and frames are read in order
+//from position 0 a frame never straddles the wrap point, so it can be handed out as a span without copying
+//
+//positions are free running 64 bit counters, each on its own cache line so the two threads do not false share
+class SampleRing{
+public:
+    //allocates, so call before the audio thread starts pushing
+    void prepare(int frameSize, int numFrames);
+    //frees the storage, neither thread may be using the ring
+    void release();
+
+    //audio thread: appends numSamples samples, a block that does not fit is dropped whole and counted as overflow
+    //returns false if the block was dropped
+    bool push(const float* samples, int numSamples);
+
+    //reader: number of complete frames waiting to be read
+    int getNumFramesAvailable() const;
+
+    //reader: view of the oldest complete frame, it stays valid until releaseFrame() is called
+    SampleSpan peekFrame() const;
+    void releaseFrame();
+
+    //total number of samples the audio thread had to drop because the reader fell behind
+    juce::uint64 getNumOverflowedSamples() const { return overflowedSamples.load(std::memory_order_relaxed); }
+
+    int getFrameSize() const { return frameSize; }
+
+private:
+    std::vector<float> storage;
+    int capacity = 0;
+    int frameSize = 0;
+
+    alignas(64) std::atomic<juce::uint64> writePosition { 0 };
+    alignas(64) std::atomic<juce::uint64> readPosition { 0 };
+    alignas(64) std::atomic<juce::uint64> overflowedSamples { 0 };
+};
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    Spectrogram.cpp
+    Scrolling time/frequency view fed one analyzer frame at a time
+
+  ==============================================================================
+*/
+
+#include "Spectrogram.h"
+
+SpectrogramComponent::SpectrogramComponent(){
+    setOpaque(true);
+
+    //black through blue, magenta and orange to white, quiet to loud
+    juce::ColourGradient gradient(juce::Colours::black, 0.f, 0.f, juce::Colours::white, 1.f, 0.f, false);
+    gradient.addColour(0.3, juce::Colours::darkblue);
+    gradient.addColour(0.55, juce::Colours::darkmagenta);
+    gradient.addColour(0.8, juce::Colours::orange);
+
+    for(int i = 0; i < LutSize; ++i){
+        colourLut[static_cast<size_t>(i)] = gradient.getColourAtPosition(double(i) / (LutSize - 1)).getPixelARGB();
+    }
+}
+
+void SpectrogramComponent::resized(){
+    auto w = getWidth();
+    auto h = getHeight();
+    if(w <= 0 || h <= 0){
+        image = {};
+        return;
+    }
+
+    //history does not survive a resize, the image starts out silent
+    image = juce::Image(juce::Image::ARGB, w, h, false);
+    image.clear(image.getBounds(), juce::Colour(colourLut.front()));
+    writeColumn = 0;
+
+    rowPositions.resize(static_cast<size_t>(h));
+    for(int y = 0; y < h; ++y){
+        rowPositions[static_cast<size_t>(y)] = 1.f - (static_cast<float>(y) + 0.5f) / static_cast<float>(h);
+    }
+}
+
+void SpectrogramComponent::pushFrame(const std::vector<float>& levels){
+    if(! image.isValid() || levels.empty()){
+        return;
+    }
+
+    auto h = image.getHeight();
+    auto lastLevel = static_cast<float>(levels.size() - 1);
+    auto scale = (LutSize - 1) / -floorDecibels;
+
+    juce::Image::BitmapData pixels(image, writeColumn, 0, 1, h, juce::Image::BitmapData::writeOnly);
+    for(int y = 0; y < h; ++y){
+        auto level = levels[static_cast<size_t>(rowPositions[static_cast<size_t>(y)] * lastLevel + 0.5f)];
+        auto index = juce::jlimit(0, LutSize - 1, static_cast<int>((level - floorDecibels) * scale));
+        *reinterpret_cast<juce::PixelARGB*>(pixels.getLinePointer(y)) = colourLut[static_cast<size_t>(index)];
+    }
+
+    writeColumn = (writeColumn + 1) % image.getWidth();
+    repaint();
+}
+
+void SpectrogramComponent::paint(juce::Graphics& g){
+    ScopedPaint scopedPaint(*this);
+
+    if(! image.isValid()){
+        g.fillAll(juce::Colours::black);
+        return;
+    }
+
+    //oldest columns start at writeColumn, they go on the left and the newest ones wrap around to the right
+    auto w = image.getWidth();
+    auto h = image.getHeight();
+    auto older = w - writeColumn;
+
+    g.drawImage(image, 0, 0, older, h, writeColumn, 0, older, h);
+    if(writeColumn > 0){
+        g.drawImage(image, older, 0, writeColumn, h, 0, 0, writeColumn, h);
+    }
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    Spectrogram.h
+    Scrolling time/frequency view fed one analyzer frame at a time
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "RenderScheduler.h"
+
+#include <array>
+#include <vector>
+
+//time runs left to right and frequency bottom to top on the same 20 Hz - 20 kHz log scale as the response curve
+//the image is a ring of columns: each frame overwrites the oldest column through BitmapData and a colour lookup
+//table, and paint draws the two halves either side of the write position, so a new frame costs one column of
+//pixels instead of redrawing or scrolling the whole image
+//frames are pushed from the response curve's frame, so the scheduler only needs it as a client to time its paint
+struct SpectrogramComponent : juce::Component, RenderScheduler::Client{
+    SpectrogramComponent();
+
+    //message thread: levels are one value per response curve column from 20 Hz to 20 kHz, in decibels
+    void pushFrame(const std::vector<float>& levels);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    //levels map onto the lookup table from this floor up to 0 dB
+    void setFloorDecibels(float newFloor) { floorDecibels = newFloor; }
+
+private:
+    static constexpr int LutSize = 256;
+    std::array<juce::PixelARGB, LutSize> colourLut;
+
+    juce::Image image;
+    //column the next frame goes into, everything to its right is older
+    int writeColumn = 0;
+    float floorDecibels = -48.f;
+
+    //per image row the fraction of the way from 20 Hz to 20 kHz, recomputed on resize
+    std::vector<float> rowPositions;
+};
@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+    Background thread turning FIFO frames into one level per pixel column for each trace
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer(SimpleEQAudioProcessor& processor)
+    : SpectrumAnalyzer(processor.leftPreFifo, processor.rightPreFifo, processor.leftChannelFifo, processor.rightChannelFifo){
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(Fifo& leftPre, Fifo& rightPre, Fifo& leftPost, Fifo& rightPost)
+    : juce::Thread("Spectrum Analyzer"),
+      fifos{&leftPre, &rightPre, &leftPost, &rightPost}{
+    configure(requestedOrder.load(), requestedOverlap.load());
+    applyIsaLevel(requestedIsa.load());
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer(){
+    stopThread(1000);
+}
+
+//allocates the FFT, window and buffers for a new size, only ever called on the worker (or before it starts)
+void SpectrumAnalyzer::configure(int order, float overlap){
+    auto frameSize = Fifo::FrameSize;
+    auto newHop = static_cast<int>(std::round((1 << order) * (1.f - overlap) / frameSize)) * frameSize;
+    newHop = juce::jmax(frameSize, newHop);
+
+    if(order == fftOrder && newHop == hopSize){
+        return;
+    }
+
+    if(order != fftOrder){
+        fftOrder = order;
+        fftSize = 1 << order;
+        numBins = fftSize / 2 + 1;
+        fft = std::make_unique<juce::dsp::FFT>(order);
+        window = std::make_unique<juce::dsp::WindowingFunction<float>>(static_cast<size_t>(fftSize),
+                                                                        juce::dsp::WindowingFunction<float>::blackmanHarris);
+        for(auto& tapSamples : windowed){
+            tapSamples.assign(static_cast<size_t>(fftSize), 0.f);
+        }
+        //the window applied to ones gives its table, windowed[0] is overwritten by the first FFT anyway
+        std::fill(windowed[0].begin(), windowed[0].end(), 1.f);
+        window->multiplyWithWindowingTable(windowed[0].data(), static_cast<size_t>(fftSize));
+        windowPower = 0.f;
+        for(auto w : windowed[0]){
+            windowPower += w * w;
+        }
+        packed.assign(static_cast<size_t>(fftSize), {});
+        transformed.assign(static_cast<size_t>(fftSize), {});
+        for(auto& spectrum : spectra){
+            spectrum.assign(static_cast<size_t>(numBins * 2), 0.f);
+        }
+        combined.assign(static_cast<size_t>(numBins * 2), 0.f);
+        binPower.assign(static_cast<size_t>(numBins), 0.f);
+
+        for(auto& stage : stages){
+            for(auto& channelWindow : stage.windows){
+                channelWindow.assign(static_cast<size_t>(fftSize), 0.f);
+            }
+            stage.write = 0;
+            for(auto& tapSums : stage.powerSums){
+                for(auto& sums : tapSums){
+                    sums.assign(static_cast<size_t>(numBins + 1), 0.0);
+                }
+            }
+        }
+    }
+
+    for(auto& channel : decimated){
+        channel.resize(static_cast<size_t>(Fifo::FrameSize));
+    }
+    hopSize = newHop;
+    for(auto& stage : stages){
+        stage.samplesSinceFFT = 0;
+        stage.hopElapsed = false;
+    }
+}
+
+void SpectrumAnalyzer::applyIsaLevel(IsaLevel isa){
+    isaLevel = isa;
+    binPowers = getBinPowersKernel(isa);
+    decibels = getDecibelsKernel(isa);
+    for(auto& stage : stages){
+        for(auto& decimator : stage.decimators){
+            decimator.setIsaLevel(isa);
+        }
+    }
+}
+
+void SpectrumAnalyzer::run(){
+    while(! threadShouldExit()){
+        configure(requestedOrder.load(), requestedOverlap.load());
+        if(requestedIsa.load() != isaLevel){
+            applyIsaLevel(requestedIsa.load());
+        }
+        
+        //frames are read in place from the FIFO's ring and released as soon as they are in the sliding windows
+        //if the thread fell behind only the newest windows are analyzed, there is no point drawing stale ones
+        //processBlock pushes the FIFOs in signal order and stops at the first one that is full, releasing them in
+        //reverse order means a later FIFO never has less room than an earlier one, so they all stay in step
+        while(std::all_of(fifos.begin(), fifos.end(), [](const Fifo* f){
+                  return f->isPrepared() && f->getNumCompleteBuffersAvailable() > 0;
+              })){
+            std::array<SampleSpan, NumSignals> signalFrames;
+            for(size_t s = 0; s < NumSignals; ++s){
+                signalFrames[s] = fifos[s]->peekFrame();
+            }
+            feedStages(signalFrames);
+            for(auto f = fifos.rbegin(); f != fifos.rend(); ++f){
+                (*f)->releaseFrame();
+            }
+        }
+
+        //stages that have not reached their next hop keep their previous levels in the merged spectrum
+        bool analyzed = false;
+        for(auto& stage : stages){
+            if(stage.hopElapsed){
+                stage.hopElapsed = false;
+                analyzeStage(stage);
+                analyzed = true;
+            }
+        }
+
+        auto numColumns = displayWidth.load();
+        if(analyzed && numColumns > 0){
+            auto& frame = frames.getWriteSlot();
+            mergeColumns(frame, numColumns, sampleRate.load());
+            frames.publish();
+        }
+
+        wait(5);
+    }
+}
+
+//stage 0 takes the frames as they are, every further stage takes half as many samples as the one above
+void SpectrumAnalyzer::feedStages(const std::array<SampleSpan, NumSignals>& signalFrames){
+    auto numSamples = signalFrames[0].size;
+    for(size_t s = 0; s < NumSignals; ++s){
+        jassert(signalFrames[s].size == numSamples);
+        std::copy(signalFrames[s].begin(), signalFrames[s].end(), decimated[s].begin());
+    }
+    appendToStage(stages[0], numSamples);
+
+    for(int k = 1; k < NumStages; ++k){
+        auto& stage = stages[static_cast<size_t>(k)];
+        int numDecimated = 0;
+        for(size_t s = 0; s < NumSignals; ++s){
+            numDecimated = stage.decimators[s].process(decimated[s].data(), numSamples, decimated[s].data());
+        }
+        numSamples = numDecimated;
+        appendToStage(stage, numSamples);
+    }
+}
+
+//copies the newest decimated samples into the circular windows with at most two copies per signal
+void SpectrumAnalyzer::appendToStage(Stage& stage, int numSamples){
+    auto n = juce::jmin(numSamples, fftSize);
+    auto first = juce::jmin(n, fftSize - stage.write);
+
+    for(size_t s = 0; s < NumSignals; ++s){
+        auto* src = decimated[s].data() + numSamples - n;
+        std::copy(src, src + first, stage.windows[s].begin() + stage.write);
+        std::copy(src + first, src + n, stage.windows[s].begin());
+    }
+    stage.write = (stage.write + n) % fftSize;
+
+    stage.samplesSinceFFT += numSamples;
+    if(stage.samplesSinceFFT >= hopSize){
+        stage.samplesSinceFFT %= hopSize;
+        stage.hopElapsed = true;
+    }
+}
+
+void SpectrumAnalyzer::analyzeStage(Stage& stage){
+    for(size_t ch = 0; ch < 2; ++ch){
+        //unroll both taps' circular windows oldest sample first and apply the window
+        for(size_t tap = 0; tap < NumAnalyzerTaps; ++tap){
+            auto& channelWindow = stage.windows[tap * 2 + ch];
+            auto oldest = channelWindow.begin() + stage.write;
+            auto next = std::copy(oldest, channelWindow.end(), windowed[tap].begin());
+            std::copy(channelWindow.begin(), oldest, next);
+            window->multiplyWithWindowingTable(windowed[tap].data(), static_cast<size_t>(fftSize));
+        }
+
+        for(int i = 0; i < fftSize; ++i){
+            packed[static_cast<size_t>(i)] = {windowed[Tap_Post][static_cast<size_t>(i)],
+                                              windowed[Tap_Pre][static_cast<size_t>(i)]};
+        }
+        fft->perform(packed.data(), transformed.data(), false);
+
+        //with z = post + j * pre and Z* the conjugate of bin N - k:
+        //    POST = (Z + Z*) / 2        PRE = (Z - Z*) / 2j
+        auto* pre = spectra[Tap_Pre * 2 + ch].data();
+        auto* post = spectra[Tap_Post * 2 + ch].data();
+        for(int k = 0; k < numBins; ++k){
+            auto z = transformed[static_cast<size_t>(k)];
+            auto mirror = std::conj(transformed[static_cast<size_t>((fftSize - k) & (fftSize - 1))]);
+            auto sum = z + mirror;
+            auto difference = z - mirror;
+            post[2 * k] = 0.5f * sum.real();
+            post[2 * k + 1] = 0.5f * sum.imag();
+            pre[2 * k] = 0.5f * difference.imag();
+            pre[2 * k + 1] = -0.5f * difference.real();
+        }
+    }
+
+    for(size_t tap = 0; tap < NumAnalyzerTaps; ++tap){
+        const auto* left = spectra[tap * 2].data();
+        const auto* right = spectra[tap * 2 + 1].data();
+        auto& sums = stage.powerSums[tap];
+
+        accumulatePowers(left, sums[Trace_Left], 1.f);
+        accumulatePowers(right, sums[Trace_Right], 1.f);
+
+        //mid and side by linearity, the halving is applied to the power as a quarter
+        auto numValues = numBins * 2;
+        juce::FloatVectorOperations::add(combined.data(), left, right, numValues);
+        accumulatePowers(combined.data(), sums[Trace_Mid], 0.25f);
+        juce::FloatVectorOperations::subtract(combined.data(), left, right, numValues);
+        accumulatePowers(combined.data(), sums[Trace_Side], 0.25f);
+    }
+}
+
+void SpectrumAnalyzer::accumulatePowers(const float* spectrum, std::vector<double>& powerSums, float gain){
+    binPowers(spectrum, binPower.data(), numBins);
+
+    double sum = 0.0;
+    powerSums[0] = 0.0;
+    for(int bin = 0; bin < numBins; ++bin){
+        sum += binPower[static_cast<size_t>(bin)] * gain;
+        powerSums[static_cast<size_t>(bin + 1)] = sum;
+    }
+}
+
+//each column is centred on a log spaced frequency of 20 Hz - 20 kHz, its band is 1/N octave around that centre
+//but never narrower than the column itself, and it reads the lowest rate stage whose clean band still reaches the
+//top of the band
+void SpectrumAnalyzer::buildColumnBands(int numColumns, double fs, int bandsPerOctave){
+    columnBands.resize(static_cast<size_t>(numColumns));
+    auto halfBand = bandsPerOctave > 0 ? std::pow(2.0, 0.5 / bandsPerOctave) : 1.0;
+
+    for(int x = 0; x < numColumns; ++x){
+        auto startHz = juce::mapToLog10(double(x) / numColumns, 20.0, 20000.0);
+        auto endHz = juce::mapToLog10(double(x + 1) / numColumns, 20.0, 20000.0);
+        auto centreHz = std::sqrt(startHz * endHz);
+        auto lowHz = juce::jmin(startHz, centreHz / halfBand);
+        auto highHz = juce::jmax(endHz, centreHz * halfBand);
+
+        int k = NumStages - 1;
+        while(k > 0 && highHz > HalfBandDecimator::UsableBandwidth * fs / (2 << k)){
+            --k;
+        }
+
+        auto binsPerHz = fftSize / (fs / (1 << k));
+        auto first = static_cast<int>(std::ceil(lowHz * binsPerHz));
+        auto last = juce::jmin(static_cast<int>(std::floor(highHz * binsPerHz)), numBins - 1);
+
+        auto& band = columnBands[static_cast<size_t>(x)];
+        band.stage = k;
+        if(first <= last){
+            band.first = first;
+            band.count = last - first + 1;
+            band.frac = 0.f;
+        }
+        else{
+            auto centreBin = centreHz * binsPerHz;
+            band.first = juce::jlimit(0, numBins - 2, static_cast<int>(centreBin));
+            band.count = 0;
+            band.frac = static_cast<float>(juce::jlimit(0.0, 1.0, centreBin - band.first));
+        }
+    }
+
+    tableFFTSize = fftSize;
+    tableSampleRate = fs;
+    tableSmoothing = bandsPerOctave;
+}
+
+void SpectrumAnalyzer::mergeColumns(AnalyzerFrame& frame, int numColumns, double fs){
+    auto bandsPerOctave = smoothing.load();
+    if(static_cast<int>(columnBands.size()) != numColumns || tableFFTSize != fftSize
+       || tableSampleRate != fs || tableSmoothing != bandsPerOctave){
+        buildColumnBands(numColumns, fs, bandsPerOctave);
+    }
+
+    columnPower.resize(static_cast<size_t>(numColumns));
+
+    //a bin of stage k estimates the one sided density times fs_k * windowPower / 2, with fs_k = fs / 2^k, so as
+    //density in one stage 0 bin (fs / fftSize) its power is scaled by 2^(k + 1) / (fftSize * windowPower)
+    //a plain mean of bins with one scale for all stages would drop white noise by 3 dB at every handover, as the
+    //decimators keep the passband at unity gain and so stage k sees 2^-k of the noise power in a bin of the same size
+    std::array<double, NumStages> stageScales;
+    for(int k = 0; k < NumStages; ++k){
+        stageScales[static_cast<size_t>(k)] = static_cast<double>(2 << k) / (static_cast<double>(fftSize) * windowPower);
+    }
+
+    for(size_t tap = 0; tap < NumAnalyzerTaps; ++tap){
+        for(size_t trace = 0; trace < NumAnalyzerTraces; ++trace){
+            for(int x = 0; x < numColumns; ++x){
+                const auto& band = columnBands[static_cast<size_t>(x)];
+                const auto* sums = stages[static_cast<size_t>(band.stage)].powerSums[tap][trace].data();
+
+                double power;
+                if(band.count > 0){
+                    power = (sums[band.first + band.count] - sums[band.first]) / band.count;
+                }
+                else{
+                    auto lower = sums[band.first + 1] - sums[band.first];
+                    auto upper = sums[band.first + 2] - sums[band.first + 1];
+                    power = lower + (upper - lower) * band.frac;
+                }
+                columnPower[static_cast<size_t>(x)] = static_cast<float>(power * stageScales[static_cast<size_t>(band.stage)]);
+            }
+
+            auto& levels = frame.levels[tap][trace];
+            levels.resize(static_cast<size_t>(numColumns));
+            decibels(columnPower.data(), levels.data(), numColumns, 1.f, MinDecibels);
+        }
+    }
+}
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+    Background thread turning FIFO frames into one level per pixel column for each trace
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "PluginProcessor.h"
+#include "TripleBuffer.h"
+#include "HalfBandDecimator.h"
+#include "SpectrumMath.h"
+
+#include <array>
+#include <vector>
+
+//mid and side are (L + R) / 2 and (L - R) / 2
+enum AnalyzerTrace{
+    Trace_Left,
+    Trace_Right,
+    Trace_Mid,
+    Trace_Side,
+    NumAnalyzerTraces
+};
+
+//where the signal is taken from, before or after the EQ
+enum AnalyzerTap{
+    Tap_Pre,
+    Tap_Post,
+    NumAnalyzerTaps
+};
+
+//analyzer output ready to be drawn, per tap and trace one level in decibels per pixel column from 20 Hz to 20 kHz
+//on a log axis
+struct AnalyzerFrame{
+    std::array<std::array<std::vector<float>, NumAnalyzerTraces>, NumAnalyzerTaps> levels;
+};
+
+//the worker drains the pre and post EQ channel FIFOs into sliding windows, runs windowed FFTs over them every hop, converts the
+//magnitudes to decibels and reduces them to pixel columns, then publishes the result through a triple buffer
+//the message thread only ever picks up the latest finished frame
+//FFT size and hop are set here rather than by the host block size, so resolution and CPU cost stay the same
+//whatever buffer size the DAW runs
+//
+//the analysis is multirate: each stage halves the rate of the one before with a half-band decimator and runs the
+//same size FFT, so every octave further down gets twice the frequency resolution
+//each pixel column reads the lowest rate stage that still covers it, which gives roughly constant Q on the log
+//axis for about twice the cost of a single FFT, instead of one FFT 2^(NumStages - 1) times as large
+//
+//columns are 1/N octave power averages taken from per stage prefix sums through a column to band table that is
+//only rebuilt when the FFT size, sample rate, width or smoothing change, so decibels are computed once per column
+//rather than once per bin
+//
+//levels are power spectral density, given as the power in the bandwidth of one stage 0 bin (sampleRate / fftSize)
+//and corrected for the window's equivalent noise bandwidth, so white noise reads flat at the same level through
+//every stage, at 10 log10(variance / (fftSize / 2)), about -33 dB for unit variance with a 4096 point FFT
+//a steady sine peaks at its power less the window's ENBW of 3 dB in stage 0, -6 dB at full scale, and 3 dB higher
+//in each stage below, whose bins are half as wide, Tests/Source/SpectrumAnalyzerTests.cpp checks the noise level
+//
+//only left and right are transformed, the FFT is linear so the mid and side spectra are the half sum and half
+//difference of those two complex spectra
+//pre and post of a channel are both real, so they go into one complex FFT as post + j * pre and are separated
+//again through the conjugate symmetry of real spectra, which makes all eight traces cost two complex FFTs
+class SpectrumAnalyzer : public juce::Thread{
+public:
+    using Fifo = SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>;
+
+    SpectrumAnalyzer(SimpleEQAudioProcessor& processor);
+    //reads the given FIFOs instead of the processor's, pre EQ left and right and then post EQ left and right
+    SpectrumAnalyzer(Fifo& leftPre, Fifo& rightPre, Fifo& leftPost, Fifo& rightPost);
+    ~SpectrumAnalyzer() override;
+
+    //message thread: the worker picks up changes on its next frame
+    void setDisplayWidth(int numColumns) { displayWidth.store(numColumns); }
+    void setSampleRate(double newSampleRate) { sampleRate.store(newSampleRate); }
+    
+    //message thread: FFT order (11 = 2048 ... 13 = 8192) and overlap between successive FFTs (0.5 = hop of half the FFT)
+    //the hop is rounded to whole FIFO frames
+    void setFFTOrder(int order) { requestedOrder.store(juce::jlimit(MinFFTOrder, MaxFFTOrder, order)); }
+    void setOverlap(float overlap) { requestedOverlap.store(juce::jlimit(0.f, 0.9375f, overlap)); }
+    //message thread: width of the smoothing band as bands per octave (3 = 1/3 octave), 0 averages each column alone
+    void setSmoothing(int bandsPerOctave) { smoothing.store(juce::jmax(0, bandsPerOctave)); }
+    //message thread: instruction set the decimators and bin conversions are built for, normally the processor's
+    //getIsaLevel(), the worker switches kernels before its next frame
+    void setIsaLevel(IsaLevel isa) { requestedIsa.store(isa); }
+
+    //message thread: takes the newest published frame, returns false if nothing new arrived since the last call
+    bool pullLatest() { return frames.pull(); }
+    const AnalyzerFrame& getLatest() const { return frames.getReadSlot(); }
+
+    //lowest level that is displayed, also used as the floor of the decibel conversion
+    static constexpr float MinDecibels = -48.f;
+
+    void run() override;
+
+    static constexpr int MinFFTOrder = 11;
+    static constexpr int MaxFFTOrder = 13;
+    //stage k runs at sampleRate / 2^k
+    static constexpr int NumStages = 4;
+
+private:
+    //signal s is channel s % 2 (left, right) of tap s / 2, matching the order processBlock pushes them in
+    static constexpr int NumSignals = 2 * NumAnalyzerTaps;
+    std::array<Fifo*, NumSignals> fifos;
+
+    //configuration the worker is currently running with, rebuilt when the requested one differs
+    int fftOrder = 0;
+    int fftSize = 0;
+    int numBins = 0;
+    int hopSize = 0;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    //sum of the squared window, the window's share of a bin's noise power
+    float windowPower = 0.f;
+
+    struct Stage{
+        //per signal, feeds this stage from the one above it, unused by stage 0
+        std::array<HalfBandDecimator, NumSignals> decimators;
+        //per signal most recent fftSize samples as a circular buffer, write is where the next sample goes (so the oldest)
+        std::array<std::vector<float>, NumSignals> windows;
+        int write = 0;
+        //samples received since the last FFT, counted at this stage's rate
+        int samplesSinceFFT = 0;
+        bool hopElapsed = false;
+        //per tap and trace bin powers of the last FFT as running sums, powerSums[tap][t][b] is the total of bins
+        //0 .. b - 1, kept in double so a quiet band next to loud ones does not vanish in the subtraction
+        std::array<std::array<std::vector<double>, NumAnalyzerTraces>, NumAnalyzerTaps> powerSums;
+    };
+    std::array<Stage, NumStages> stages;
+
+    //where one pixel column reads from: the average of count bins starting at first, or when the band is
+    //narrower than a bin (count == 0) bins first and first + 1 mixed by frac
+    struct ColumnBand{
+        int stage = 0;
+        int first = 0;
+        int count = 0;
+        float frac = 0.f;
+    };
+    std::vector<ColumnBand> columnBands;
+    //settings the table was built for
+    int tableFFTSize = 0;
+    int tableSmoothing = -1;
+    double tableSampleRate = 0.0;
+
+    std::vector<float> binPower;
+    std::vector<float> columnPower;
+
+    //per signal frame being passed down the stages, decimated in place
+    std::array<std::vector<float>, NumSignals> decimated;
+    //windowed pre and post samples of one channel, and the post + j * pre FFT input and output
+    std::array<std::vector<float>, NumAnalyzerTaps> windowed;
+    std::vector<juce::dsp::Complex<float>> packed, transformed;
+    //per signal non negative frequency bins as re, im pairs
+    std::array<std::vector<float>, NumSignals> spectra;
+    //sum or difference of the two channel spectra of a tap
+    std::vector<float> combined;
+
+    TripleBuffer<AnalyzerFrame> frames;
+
+    std::atomic<int> displayWidth { 0 };
+    std::atomic<double> sampleRate { 44100.0 };
+    std::atomic<int> requestedOrder { 12 };
+    std::atomic<float> requestedOverlap { 0.75f };
+    std::atomic<int> smoothing { 6 };
+    std::atomic<IsaLevel> requestedIsa { selectIsaLevel() };
+
+    //kernels the worker is currently running with
+    IsaLevel isaLevel = IsaLevel::Scalar;
+    BinPowersKernel binPowers { computeBinPowers };
+    DecibelsKernel decibels { powersToDecibels };
+
+    void configure(int order, float overlap);
+    void applyIsaLevel(IsaLevel isa);
+    void feedStages(const std::array<SampleSpan, NumSignals>& signalFrames);
+    void appendToStage(Stage& stage, int numSamples);
+    void analyzeStage(Stage& stage);
+    void accumulatePowers(const float* spectrum, std::vector<double>& powerSums, float gain);
+    void buildColumnBands(int numColumns, double fs, int bandsPerOctave);
+    void mergeColumns(AnalyzerFrame& frame, int numColumns, double fs);
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumAnalyzer)
+};
@@ -0,0 +1,257 @@
+/*
+  ==============================================================================
+
+    SpectrumMath.cpp
+    Vectorized bin power and decibel conversion for the analyzer
+
+  ==============================================================================
+*/
+
+#include "SpectrumMath.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+#if JUCE_ARM && defined(__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+namespace{
+    //10 * log10(2), turns log2 of a power into decibels
+    constexpr float DecibelsPerLog2 = 3.0102999566f;
+
+    //least squares fit of log2(1 + t) on [0, 1)
+    constexpr float C1 = 1.4418258726f;
+    constexpr float C2 = -0.7086829230f;
+    constexpr float C3 = 0.4154247223f;
+    constexpr float C4 = -0.1944263690f;
+    constexpr float C5 = 0.0458872202f;
+
+    //smallest power that is still a normal float, keeps the exponent trick valid for silent bins
+    constexpr float MinPower = 1.0e-37f;
+
+    inline float fastLog2(float x){
+        juce::uint32 bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        auto exponent = static_cast<float>(static_cast<int>(bits >> 23) - 127);
+        bits = (bits & 0x007fffffu) | 0x3f800000u;
+        float mantissa;
+        std::memcpy(&mantissa, &bits, sizeof(mantissa));
+        auto t = mantissa - 1.f;
+        return exponent + t * (C1 + t * (C2 + t * (C3 + t * (C4 + t * C5))));
+    }
+}
+
+//the scalar loops are the tails of every vector build, from the first index the vector loop left
+static void addBinPowers(const float* interleaved, float* power, int i, int numBins){
+    for(; i < numBins; ++i){
+        auto re = interleaved[2 * i];
+        auto im = interleaved[2 * i + 1];
+        power[i] = re * re + im * im;
+    }
+}
+
+static void addDecibels(const float* power, float* decibels, int i, int numValues, float scale, float floorDb){
+    for(; i < numValues; ++i){
+        auto x = juce::jmax(power[i] * scale, MinPower);
+        decibels[i] = juce::jmax(fastLog2(x) * DecibelsPerLog2, floorDb);
+    }
+}
+
+static void computeBinPowersScalar(const float* interleaved, float* power, int numBins){
+    addBinPowers(interleaved, power, 0, numBins);
+}
+
+static void powersToDecibelsScalar(const float* power, float* decibels, int numValues, float scale, float floorDb){
+    addDecibels(power, decibels, 0, numValues, scale, floorDb);
+}
+
+#if JUCE_INTEL
+static void computeBinPowersSSE2(const float* interleaved, float* power, int numBins){
+    int i = 0;
+    //two loads give re0 im0 re1 im1 and re2 im2 re3 im3, squaring and adding the even and odd lanes gives four powers
+    for(; i + 4 <= numBins; i += 4){
+        auto a = _mm_loadu_ps(interleaved + 2 * i);
+        auto b = _mm_loadu_ps(interleaved + 2 * i + 4);
+        a = _mm_mul_ps(a, a);
+        b = _mm_mul_ps(b, b);
+        auto re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        auto im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(power + i, _mm_add_ps(re, im));
+    }
+    addBinPowers(interleaved, power, i, numBins);
+}
+
+static void powersToDecibelsSSE2(const float* power, float* decibels, int numValues, float scale, float floorDb){
+    int i = 0;
+    auto vScale = _mm_set1_ps(scale);
+    auto vMinPower = _mm_set1_ps(MinPower);
+    auto vFloor = _mm_set1_ps(floorDb);
+    auto vDb = _mm_set1_ps(DecibelsPerLog2);
+    auto vOne = _mm_set1_ps(1.f);
+    auto mantissaMask = _mm_set1_epi32(0x007fffff);
+    auto oneBits = _mm_set1_epi32(0x3f800000);
+    auto bias = _mm_set1_epi32(127);
+
+    for(; i + 4 <= numValues; i += 4){
+        auto x = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(power + i), vScale), vMinPower);
+        auto bits = _mm_castps_si128(x);
+        auto exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+        auto t = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissaMask), oneBits)), vOne);
+
+        auto p = _mm_add_ps(_mm_set1_ps(C4), _mm_mul_ps(t, _mm_set1_ps(C5)));
+        p = _mm_add_ps(_mm_set1_ps(C3), _mm_mul_ps(t, p));
+        p = _mm_add_ps(_mm_set1_ps(C2), _mm_mul_ps(t, p));
+        p = _mm_add_ps(_mm_set1_ps(C1), _mm_mul_ps(t, p));
+        auto log2 = _mm_add_ps(exponent, _mm_mul_ps(t, p));
+
+        _mm_storeu_ps(decibels + i, _mm_max_ps(_mm_mul_ps(log2, vDb), vFloor));
+    }
+    addDecibels(power, decibels, i, numValues, scale, floorDb);
+}
+#endif
+
+#if SIMPLEEQ_AVX2
+//eight bins per step, hadd adds the squared pairs within each 128 bit half, which leaves the powers of bins 0 1 4 5
+//in the low half and 2 3 6 7 in the high one, the 64 bit permute puts the pairs back in order
+SIMPLEEQ_TARGET_AVX2
+static void computeBinPowersAVX2(const float* interleaved, float* power, int numBins){
+    int i = 0;
+    for(; i + 8 <= numBins; i += 8){
+        auto a = _mm256_loadu_ps(interleaved + 2 * i);
+        auto b = _mm256_loadu_ps(interleaved + 2 * i + 8);
+        auto sums = _mm256_hadd_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b));
+        auto ordered = _mm256_permute4x64_pd(_mm256_castps_pd(sums), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_ps(power + i, _mm256_castpd_ps(ordered));
+    }
+    addBinPowers(interleaved, power, i, numBins);
+}
+
+//the SSE2 conversion eight wide, with the polynomial as fused multiply-adds
+SIMPLEEQ_TARGET_AVX2
+static void powersToDecibelsAVX2(const float* power, float* decibels, int numValues, float scale, float floorDb){
+    int i = 0;
+    auto vScale = _mm256_set1_ps(scale);
+    auto vMinPower = _mm256_set1_ps(MinPower);
+    auto vFloor = _mm256_set1_ps(floorDb);
+    auto vDb = _mm256_set1_ps(DecibelsPerLog2);
+    auto vOne = _mm256_set1_ps(1.f);
+    auto mantissaMask = _mm256_set1_epi32(0x007fffff);
+    auto oneBits = _mm256_set1_epi32(0x3f800000);
+    auto bias = _mm256_set1_epi32(127);
+
+    for(; i + 8 <= numValues; i += 8){
+        auto x = _mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(power + i), vScale), vMinPower);
+        auto bits = _mm256_castps_si256(x);
+        auto exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), bias));
+        auto t = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, mantissaMask), oneBits)),
+                               vOne);
+
+        auto p = _mm256_fmadd_ps(t, _mm256_set1_ps(C5), _mm256_set1_ps(C4));
+        p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(C3));
+        p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(C2));
+        p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(C1));
+        auto log2 = _mm256_fmadd_ps(t, p, exponent);
+
+        _mm256_storeu_ps(decibels + i, _mm256_max_ps(_mm256_mul_ps(log2, vDb), vFloor));
+    }
+    addDecibels(power, decibels, i, numValues, scale, floorDb);
+}
+#endif
+
+#if JUCE_ARM && defined(__ARM_NEON)
+static void computeBinPowersNEON(const float* interleaved, float* power, int numBins){
+    int i = 0;
+    //vld2 de-interleaves the pairs on load
+    for(; i + 4 <= numBins; i += 4){
+        auto pairs = vld2q_f32(interleaved + 2 * i);
+        vst1q_f32(power + i, vmlaq_f32(vmulq_f32(pairs.val[0], pairs.val[0]), pairs.val[1], pairs.val[1]));
+    }
+    addBinPowers(interleaved, power, i, numBins);
+}
+
+static void powersToDecibelsNEON(const float* power, float* decibels, int numValues, float scale, float floorDb){
+    int i = 0;
+    auto vScale = vdupq_n_f32(scale);
+    auto vMinPower = vdupq_n_f32(MinPower);
+    auto vFloor = vdupq_n_f32(floorDb);
+    auto vOne = vdupq_n_f32(1.f);
+    auto mantissaMask = vdupq_n_u32(0x007fffffu);
+    auto oneBits = vdupq_n_u32(0x3f800000u);
+    auto bias = vdupq_n_s32(127);
+
+    for(; i + 4 <= numValues; i += 4){
+        auto x = vmaxq_f32(vmulq_f32(vld1q_f32(power + i), vScale), vMinPower);
+        auto bits = vreinterpretq_u32_f32(x);
+        auto exponent = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), bias));
+        auto t = vsubq_f32(vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, mantissaMask), oneBits)), vOne);
+
+        auto p = vmlaq_n_f32(vdupq_n_f32(C4), t, C5);
+        p = vmlaq_f32(vdupq_n_f32(C3), t, p);
+        p = vmlaq_f32(vdupq_n_f32(C2), t, p);
+        p = vmlaq_f32(vdupq_n_f32(C1), t, p);
+        auto log2 = vmlaq_f32(exponent, t, p);
+
+        vst1q_f32(decibels + i, vmaxq_f32(vmulq_n_f32(log2, DecibelsPerLog2), vFloor));
+    }
+    addDecibels(power, decibels, i, numValues, scale, floorDb);
+}
+#endif
+
+void computeBinPowers(const float* interleaved, float* power, int numBins){
+   #if JUCE_INTEL
+    computeBinPowersSSE2(interleaved, power, numBins);
+   #elif JUCE_ARM && defined(__ARM_NEON)
+    computeBinPowersNEON(interleaved, power, numBins);
+   #else
+    computeBinPowersScalar(interleaved, power, numBins);
+   #endif
+}
+
+void powersToDecibels(const float* power, float* decibels, int numValues, float scale, float floorDb){
+   #if JUCE_INTEL
+    powersToDecibelsSSE2(power, decibels, numValues, scale, floorDb);
+   #elif JUCE_ARM && defined(__ARM_NEON)
+    powersToDecibelsNEON(power, decibels, numValues, scale, floorDb);
+   #else
+    powersToDecibelsScalar(power, decibels, numValues, scale, floorDb);
+   #endif
+}
+
+BinPowersKernel getBinPowersKernel(IsaLevel isa){
+    switch(isa){
+       #if JUCE_INTEL
+        case IsaLevel::SSE2:
+            return computeBinPowersSSE2;
+       #endif
+       #if SIMPLEEQ_AVX2
+        case IsaLevel::AVX2:
+            return computeBinPowersAVX2;
+       #endif
+       #if JUCE_ARM && defined(__ARM_NEON)
+        case IsaLevel::NEON:
+            return computeBinPowersNEON;
+       #endif
+        default:
+            return computeBinPowersScalar;
+    }
+}
+
+DecibelsKernel getDecibelsKernel(IsaLevel isa){
+    switch(isa){
+       #if JUCE_INTEL
+        case IsaLevel::SSE2:
+            return powersToDecibelsSSE2;
+       #endif
+       #if SIMPLEEQ_AVX2
+        case IsaLevel::AVX2:
+            return powersToDecibelsAVX2;
+       #endif
+       #if JUCE_ARM && defined(__ARM_NEON)
+        case IsaLevel::NEON:
+            return powersToDecibelsNEON;
+       #endif
+        default:
+            return powersToDecibelsScalar;
+    }
+}
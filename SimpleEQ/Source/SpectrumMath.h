@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+
+    SpectrumMath.h
+    Vectorized bin power and decibel conversion for the analyzer
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "CpuDispatch.h"
+
+//power of each bin from the output of performRealOnlyForwardTransform (re, im pairs), power[i] = re^2 + im^2
+//no square root is taken, levels are averaged as power and only the averages are converted to decibels
+void computeBinPowers(const float* interleaved, float* power, int numBins);
+
+//decibels[i] = 10 * log10(power[i] * scale), never below floorDb
+//log10 comes from the float exponent plus a 5th order polynomial for the mantissa, accurate to about 0.0001 dB
+void powersToDecibels(const float* power, float* decibels, int numValues, float scale, float floorDb);
+
+using BinPowersKernel = void (*)(const float*, float*, int);
+using DecibelsKernel = void (*)(const float*, float*, int, float, float);
+
+//the two conversions built for the given instruction set, the functions above are the SSE2 builds on Intel and the
+//NEON builds on ARM, only pass levels isIsaSupported() accepts
+BinPowersKernel getBinPowersKernel(IsaLevel isa);
+DecibelsKernel getDecibelsKernel(IsaLevel isa);
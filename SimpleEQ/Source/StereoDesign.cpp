@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    StereoDesign.cpp
+    Coefficient design for both lanes of a stereo cascade in one call
+
+  ==============================================================================
+*/
+
+#include "StereoDesign.h"
+
+//normalizes by a0 and stores the section into one lane
+static void setLane(StereoSection& section, int lane,
+                    double b0, double b1, double b2,
+                    double a0, double a1, double a2){
+    auto a0inv = 1.0 / a0;
+    section.b0[lane] = static_cast<float>(b0 * a0inv);
+    section.b1[lane] = static_cast<float>(b1 * a0inv);
+    section.b2[lane] = static_cast<float>(b2 * a0inv);
+    section.a1[lane] = static_cast<float>(a1 * a0inv);
+    section.a2[lane] = static_cast<float>(a2 * a0inv);
+}
+
+//linked channels design lane 0 only and share it
+static void copyLane0(StereoSection& section){
+    section.b0[1] = section.b0[0];
+    section.b1[1] = section.b1[0];
+    section.b2[1] = section.b2[0];
+    section.a1[1] = section.a1[0];
+    section.a2[1] = section.a2[0];
+}
+
+void designPeakSection(StereoSection& section,
+                       double sampleRate,
+                       const std::array<float, 2>& freq,
+                       const std::array<float, 2>& quality,
+                       const std::array<float, 2>& gainInDecibels,
+                       int numLanes){
+    using namespace juce;
+    jassert(numLanes == 1 || numLanes == 2);
+
+    for(int lane = 0; lane < numLanes; ++lane){
+        auto gain = Decibels::decibelsToGain(static_cast<double>(gainInDecibels[lane]));
+        auto A = std::sqrt(jmax(gain, 1.0e-6));
+        auto omega = (MathConstants<double>::twoPi * jmax(static_cast<double>(freq[lane]), 2.0)) / sampleRate;
+        auto alpha = std::sin(omega) / (quality[lane] * 2.0);
+        auto c2 = -2.0 * std::cos(omega);
+        auto alphaTimesA = alpha * A;
+        auto alphaOverA = alpha / A;
+
+        setLane(section, lane,
+                1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+                1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+    }
+
+    if(numLanes == 1){
+        copyLane0(section);
+    }
+}
+
+void designCutSections(StereoSection* firstSection,
+                       bool highPass,
+                       double sampleRate,
+                       const std::array<float, 2>& freq,
+                       const std::array<int, 2>& slope,
+                       int numLanes){
+    using namespace juce;
+    jassert(numLanes == 1 || numLanes == 2);
+
+    for(int lane = 0; lane < numLanes; ++lane){
+        //each slope step adds a second order section, Q of each section comes from the Butterworth pole angles
+        auto order = (slope[lane] + 1) * 2;
+        auto n = std::tan(MathConstants<double>::pi * freq[lane] / sampleRate);
+        if(! highPass){
+            n = 1.0 / n;
+        }
+        auto nSquared = n * n;
+
+        for(int i = 0; i < 4; ++i){
+            auto& section = firstSection[i];
+            if(i >= order / 2){
+                setSectionLaneBypassed(section, lane);
+                continue;
+            }
+
+            auto invQ = 2.0 * std::cos((2.0 * i + 1.0) * MathConstants<double>::pi / (order * 2.0));
+            auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+            if(highPass){
+                setLane(section, lane,
+                        c1, -2.0 * c1, c1,
+                        1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+            }
+            else{
+                setLane(section, lane,
+                        c1, 2.0 * c1, c1,
+                        1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+            }
+        }
+    }
+
+    if(numLanes == 1){
+        for(int i = 0; i < 4; ++i){
+            copyLane0(firstSection[i]);
+        }
+    }
+}
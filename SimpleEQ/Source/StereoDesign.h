@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    StereoDesign.h
+    Coefficient design for both lanes of a stereo cascade in one call
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StereoKernel.h"
+
+//per lane design parameters are passed side by side, lane 0 first
+//with numLanes == 1 only lane 0 is designed and copied into lane 1, which is how linked channels share one design
+//the formulas match juce::dsp::IIR::Coefficients and juce::dsp::FilterDesign but write straight into the cascade,
+//so nothing is allocated on the audio thread
+
+//peak (bell) section, gain in decibels
+void designPeakSection(StereoSection& section,
+                       double sampleRate,
+                       const std::array<float, 2>& freq,
+                       const std::array<float, 2>& quality,
+                       const std::array<float, 2>& gainInDecibels,
+                       int numLanes);
+
+//Butterworth high pass (low cut) or low pass (high cut) of order (slope + 1) * 2 split into second order sections
+//writes 4 sections starting at firstSection, sections above a lane's slope become passthrough in that lane
+void designCutSections(StereoSection* firstSection,
+                       bool highPass,
+                       double sampleRate,
+                       const std::array<float, 2>& freq,
+                       const std::array<int, 2>& slope,
+                       int numLanes);
@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+    StereoKernel.cpp
+    Biquad cascade which runs both channels of a stereo signal in one pass
+
+  ==============================================================================
+*/
+
+#include "StereoKernel.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+#if JUCE_ARM && defined(__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+//JUCE stores normalized coefficients as {b0, b1, b2, a1, a2} for second order sections and {b0, b1, a1} for first order
+void setSectionLane(StereoSection& section, int lane, const juce::dsp::IIR::Coefficients<float>& coefficients){
+    jassert(lane == 0 || lane == 1);
+    auto* c = coefficients.coefficients.begin();
+
+    if(coefficients.coefficients.size() == 5){
+        section.b0[lane] = c[0];
+        section.b1[lane] = c[1];
+        section.b2[lane] = c[2];
+        section.a1[lane] = c[3];
+        section.a2[lane] = c[4];
+    }
+    else if(coefficients.coefficients.size() == 3){
+        section.b0[lane] = c[0];
+        section.b1[lane] = c[1];
+        section.b2[lane] = 0.f;
+        section.a1[lane] = c[2];
+        section.a2[lane] = 0.f;
+    }
+    else{
+        jassertfalse;
+    }
+}
+
+void setSectionLaneBypassed(StereoSection& section, int lane){
+    section.b0[lane] = 1.f;
+    section.b1[lane] = 0.f;
+    section.b2[lane] = 0.f;
+    section.a1[lane] = 0.f;
+    section.a2[lane] = 0.f;
+}
+
+//the active sections are copied into contiguous locals before the sample loop and the state is written back after it,
+//so the loop itself only touches the buffer and whatever the compiler keeps in registers
+void processStereoSections(const StereoSection* sections,
+                           StereoCascadeState& state,
+                           const int* slots,
+                           int numSlots,
+                           float* left,
+                           float* right,
+                           int numSamples,
+                           bool encodeMidSide,
+                           bool decodeMidSide){
+    std::array<StereoSection, MaxCascadeSlots> c;
+    std::array<StereoSectionState, MaxCascadeSlots> z;
+    for(int k = 0; k < numSlots; ++k){
+        c[k] = sections[slots[k]];
+        z[k] = state[slots[k]];
+    }
+
+    for(int i = 0; i < numSamples; ++i){
+        std::array<float, 2> x {left[i], right[i]};
+
+        //M/S encode fused into the first stage
+        if(encodeMidSide){
+            x = {(x[0] + x[1]) * 0.5f, (x[0] - x[1]) * 0.5f};
+        }
+
+        for(int k = 0; k < numSlots; ++k){
+            //both lanes share one loop body so the compiler can keep them in one vector register
+            for(int lane = 0; lane < 2; ++lane){
+                auto y = c[k].b0[lane] * x[lane] + z[k].z1[lane];
+                z[k].z1[lane] = c[k].b1[lane] * x[lane] - c[k].a1[lane] * y + z[k].z2[lane];
+                z[k].z2[lane] = c[k].b2[lane] * x[lane] - c[k].a2[lane] * y;
+                x[lane] = y;
+            }
+        }
+
+        //M/S decode fused into the last stage
+        if(decodeMidSide){
+            x = {x[0] + x[1], x[0] - x[1]};
+        }
+
+        left[i] = x[0];
+        right[i] = x[1];
+    }
+
+    for(int k = 0; k < numSlots; ++k){
+        state[slots[k]] = z[k];
+    }
+}
+
+#if JUCE_INTEL
+//both lanes live in the low half of one SSE register, coefficients and state are loaded once per block
+static void processStereoSectionsSSE2(const StereoSection* sections,
+                                      StereoCascadeState& state,
+                                      const int* slots,
+                                      int numSlots,
+                                      float* left,
+                                      float* right,
+                                      int numSamples,
+                                      bool encodeMidSide,
+                                      bool decodeMidSide){
+    //loads/stores the two floats of a lane pair through the low 64 bits of a register
+    auto load = [](const std::array<float, 2>& a){ return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(a.data()))); };
+    auto store = [](std::array<float, 2>& a, __m128 v){ _mm_storel_pi(reinterpret_cast<__m64*>(a.data()), v); };
+
+    __m128 b0[MaxCascadeSlots], b1[MaxCascadeSlots], b2[MaxCascadeSlots], a1[MaxCascadeSlots], a2[MaxCascadeSlots],
+           z1[MaxCascadeSlots], z2[MaxCascadeSlots];
+    for(int k = 0; k < numSlots; ++k){
+        const auto& c = sections[slots[k]];
+        b0[k] = load(c.b0);
+        b1[k] = load(c.b1);
+        b2[k] = load(c.b2);
+        a1[k] = load(c.a1);
+        a2[k] = load(c.a2);
+        z1[k] = load(state[slots[k]].z1);
+        z2[k] = load(state[slots[k]].z2);
+    }
+
+    //(x0 + x1, x0 - x1) in the low two lanes
+    auto sumAndDifference = [](__m128 x){
+        auto swapped = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 2, 0, 1));
+        return _mm_unpacklo_ps(_mm_add_ps(x, swapped), _mm_sub_ps(x, swapped));
+    };
+    const auto half = _mm_set1_ps(0.5f);
+
+    for(int i = 0; i < numSamples; ++i){
+        auto x = _mm_setr_ps(left[i], right[i], 0.f, 0.f);
+
+        if(encodeMidSide){
+            x = _mm_mul_ps(sumAndDifference(x), half);
+        }
+
+        for(int k = 0; k < numSlots; ++k){
+            auto y = _mm_add_ps(_mm_mul_ps(b0[k], x), z1[k]);
+            z1[k] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1[k], x), _mm_mul_ps(a1[k], y)), z2[k]);
+            z2[k] = _mm_sub_ps(_mm_mul_ps(b2[k], x), _mm_mul_ps(a2[k], y));
+            x = y;
+        }
+
+        if(decodeMidSide){
+            x = sumAndDifference(x);
+        }
+
+        left[i] = _mm_cvtss_f32(x);
+        right[i] = _mm_cvtss_f32(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+
+    for(int k = 0; k < numSlots; ++k){
+        store(state[slots[k]].z1, z1[k]);
+        store(state[slots[k]].z2, z2[k]);
+    }
+}
+
+#endif
+
+#if SIMPLEEQ_AVX2
+//the lane pair still fits the low half of an SSE register, so what this level adds is FMA: each section's recursion
+//y -> z1 -> y is three fused multiply-adds instead of three multiplies and three adds, which is the chain that
+//bounds the sample loop, as nothing else can start before the previous sample's y
+//the SSE2 lambdas are not used here, lambdas do not take the target attribute
+SIMPLEEQ_TARGET_AVX2
+static void processStereoSectionsAVX2(const StereoSection* sections,
+                                      StereoCascadeState& state,
+                                      const int* slots,
+                                      int numSlots,
+                                      float* left,
+                                      float* right,
+                                      int numSamples,
+                                      bool encodeMidSide,
+                                      bool decodeMidSide){
+    __m128 b0[MaxCascadeSlots], b1[MaxCascadeSlots], b2[MaxCascadeSlots], a1[MaxCascadeSlots], a2[MaxCascadeSlots],
+           z1[MaxCascadeSlots], z2[MaxCascadeSlots];
+    for(int k = 0; k < numSlots; ++k){
+        const auto& c = sections[slots[k]];
+        const auto& z = state[slots[k]];
+        b0[k] = _mm_setr_ps(c.b0[0], c.b0[1], 0.f, 0.f);
+        b1[k] = _mm_setr_ps(c.b1[0], c.b1[1], 0.f, 0.f);
+        b2[k] = _mm_setr_ps(c.b2[0], c.b2[1], 0.f, 0.f);
+        a1[k] = _mm_setr_ps(c.a1[0], c.a1[1], 0.f, 0.f);
+        a2[k] = _mm_setr_ps(c.a2[0], c.a2[1], 0.f, 0.f);
+        z1[k] = _mm_setr_ps(z.z1[0], z.z1[1], 0.f, 0.f);
+        z2[k] = _mm_setr_ps(z.z2[0], z.z2[1], 0.f, 0.f);
+    }
+
+    const auto half = _mm_set1_ps(0.5f);
+
+    for(int i = 0; i < numSamples; ++i){
+        auto x = _mm_setr_ps(left[i], right[i], 0.f, 0.f);
+
+        //(x0 + x1, x0 - x1) in the low two lanes
+        if(encodeMidSide){
+            auto swapped = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 2, 0, 1));
+            x = _mm_mul_ps(_mm_unpacklo_ps(_mm_add_ps(x, swapped), _mm_sub_ps(x, swapped)), half);
+        }
+
+        for(int k = 0; k < numSlots; ++k){
+            auto y = _mm_fmadd_ps(b0[k], x, z1[k]);
+            z1[k] = _mm_fnmadd_ps(a1[k], y, _mm_fmadd_ps(b1[k], x, z2[k]));
+            z2[k] = _mm_fnmadd_ps(a2[k], y, _mm_mul_ps(b2[k], x));
+            x = y;
+        }
+
+        if(decodeMidSide){
+            auto swapped = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 2, 0, 1));
+            x = _mm_unpacklo_ps(_mm_add_ps(x, swapped), _mm_sub_ps(x, swapped));
+        }
+
+        left[i] = _mm_cvtss_f32(x);
+        right[i] = _mm_cvtss_f32(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+
+    for(int k = 0; k < numSlots; ++k){
+        alignas(16) float z1Lanes[4], z2Lanes[4];
+        _mm_store_ps(z1Lanes, z1[k]);
+        _mm_store_ps(z2Lanes, z2[k]);
+        state[slots[k]].z1 = {z1Lanes[0], z1Lanes[1]};
+        state[slots[k]].z2 = {z2Lanes[0], z2Lanes[1]};
+    }
+}
+#endif
+
+#if JUCE_ARM && defined(__ARM_NEON)
+//a float32x2_t holds exactly one lane pair
+static void processStereoSectionsNEON(const StereoSection* sections,
+                                      StereoCascadeState& state,
+                                      const int* slots,
+                                      int numSlots,
+                                      float* left,
+                                      float* right,
+                                      int numSamples,
+                                      bool encodeMidSide,
+                                      bool decodeMidSide){
+    float32x2_t b0[MaxCascadeSlots], b1[MaxCascadeSlots], b2[MaxCascadeSlots], a1[MaxCascadeSlots], a2[MaxCascadeSlots],
+                z1[MaxCascadeSlots], z2[MaxCascadeSlots];
+    for(int k = 0; k < numSlots; ++k){
+        const auto& c = sections[slots[k]];
+        b0[k] = vld1_f32(c.b0.data());
+        b1[k] = vld1_f32(c.b1.data());
+        b2[k] = vld1_f32(c.b2.data());
+        a1[k] = vld1_f32(c.a1.data());
+        a2[k] = vld1_f32(c.a2.data());
+        z1[k] = vld1_f32(state[slots[k]].z1.data());
+        z2[k] = vld1_f32(state[slots[k]].z2.data());
+    }
+
+    //(x0 + x1, x0 - x1)
+    auto sumAndDifference = [](float32x2_t x){
+        auto swapped = vrev64_f32(x);
+        return vset_lane_f32(vget_lane_f32(vsub_f32(x, swapped), 0), vadd_f32(x, swapped), 1);
+    };
+
+    for(int i = 0; i < numSamples; ++i){
+        float32x2_t x = {left[i], right[i]};
+
+        if(encodeMidSide){
+            x = vmul_n_f32(sumAndDifference(x), 0.5f);
+        }
+
+        for(int k = 0; k < numSlots; ++k){
+            auto y = vmla_f32(z1[k], b0[k], x);
+            z1[k] = vmls_f32(vmla_f32(z2[k], b1[k], x), a1[k], y);
+            z2[k] = vmls_f32(vmul_f32(b2[k], x), a2[k], y);
+            x = y;
+        }
+
+        if(decodeMidSide){
+            x = sumAndDifference(x);
+        }
+
+        left[i] = vget_lane_f32(x, 0);
+        right[i] = vget_lane_f32(x, 1);
+    }
+
+    for(int k = 0; k < numSlots; ++k){
+        vst1_f32(state[slots[k]].z1.data(), z1[k]);
+        vst1_f32(state[slots[k]].z2.data(), z2[k]);
+    }
+}
+#endif
+
+StereoSectionsKernel getStereoSectionsKernel(IsaLevel isa){
+    switch(isa){
+       #if JUCE_INTEL
+        case IsaLevel::SSE2:
+            return processStereoSectionsSSE2;
+       #endif
+       #if SIMPLEEQ_AVX2
+        case IsaLevel::AVX2:
+            return processStereoSectionsAVX2;
+       #endif
+       #if JUCE_ARM && defined(__ARM_NEON)
+        case IsaLevel::NEON:
+            return processStereoSectionsNEON;
+       #endif
+        default:
+            return processStereoSections;
+    }
+}
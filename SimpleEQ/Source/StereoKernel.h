@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    StereoKernel.h
+    Biquad cascade which runs both channels of a stereo signal in one pass
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "CpuDispatch.h"
+
+#include <array>
+
+//one second order section in transposed direct form II, normalized so a0 == 1
+//coefficients for both lanes are stored side by side so a single loop can push L/R (or M/S) through the section together
+//lane 0 is Left or Mid, lane 1 is Right or Side
+struct StereoSection{
+    std::array<float, 2> b0 {1.f, 1.f}, b1 {}, b2 {}, a1 {}, a2 {};
+};
+
+//per lane filter memory for a single section
+struct StereoSectionState{
+    std::array<float, 2> z1 {}, z2 {};
+};
+
+//Low Cut (4 sections) -> Peak (1 section) -> High Cut (4 sections)
+//each slot keeps its own state so changing a slope does not shift the filter memory of the other sections
+enum CascadeSlots{
+    LowCutSlot = 0,
+    PeakSlot = 4,
+    HighCutSlot = 5,
+    MaxCascadeSlots = 9
+};
+
+//a cascade is a fixed set of slots plus a flag per slot saying whether it currently does anything
+//bypassed slots are left out when a schedule runs, the same way ProcessorChain skips bypassed links
+struct StereoCascade{
+    std::array<StereoSection, MaxCascadeSlots> sections;
+    std::array<bool, MaxCascadeSlots> active {};
+};
+
+using StereoCascadeState = std::array<StereoSectionState, MaxCascadeSlots>;
+
+//copies a JUCE designed first or second order section into one lane of a stereo section
+void setSectionLane(StereoSection& section, int lane, const juce::dsp::IIR::Coefficients<float>& coefficients);
+
+//turns one lane of a section into a passthrough, used when only the other lane needs the slot
+void setSectionLaneBypassed(StereoSection& section, int lane);
+
+//runs the given cascade slots, in order, over both channels
+//when encodeMidSide is set, L/R are converted to M/S before the first section, when decodeMidSide is set M/S are
+//converted back to L/R after the last section, so mid/side processing costs no extra pass over the buffer
+//left and right may point at the same buffer for mono layouts
+void processStereoSections(const StereoSection* sections,
+                           StereoCascadeState& state,
+                           const int* slots,
+                           int numSlots,
+                           float* left,
+                           float* right,
+                           int numSamples,
+                           bool encodeMidSide,
+                           bool decodeMidSide);
+
+using StereoSectionsKernel = void (*)(const StereoSection*, StereoCascadeState&, const int*, int, float*, float*, int, bool, bool);
+
+//processStereoSections built for the given instruction set, the portable build for levels this binary has no kernel for
+//only pass levels isIsaSupported() accepts, normally the one selectIsaLevel() returned
+StereoSectionsKernel getStereoSectionsKernel(IsaLevel isa);
@@ -0,0 +1,309 @@
+/*
+  ==============================================================================
+
+    TraceRaster.cpp
+    Scanline rasterizer for polylines with one point per pixel column
+
+  ==============================================================================
+*/
+
+#include "TraceRaster.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+#if JUCE_ARM && defined(__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+//the scalar loop is the tail of every vector build, from the first row the vector loop left
+static void addCoverage(float* coverage, int j, int rows, float dy0, float dx, float ex, float ey, float invLength2,
+                        float reach){
+    auto dxe = dx * ex;
+    for(; j < rows; ++j){
+        auto dy = dy0 + static_cast<float>(j);
+        auto t = juce::jlimit(0.f, 1.f, (dxe + dy * ey) * invLength2);
+        auto qx = dx - t * ex;
+        auto qy = dy - t * ey;
+        auto c = juce::jlimit(0.f, 1.f, reach - std::sqrt(qx * qx + qy * qy));
+        coverage[j] = juce::jmax(coverage[j], c);
+    }
+}
+
+static void coverSegmentScalar(float* coverage, int rows, float dy0, float dx, float ex, float ey, float invLength2,
+                               float reach){
+    addCoverage(coverage, 0, rows, dy0, dx, ex, ey, invLength2, reach);
+}
+
+#if JUCE_INTEL
+static void coverSegmentSSE2(float* coverage, int rows, float dy0, float dx, float ex, float ey, float invLength2,
+                             float reach){
+    int j = 0;
+    const auto zero = _mm_setzero_ps();
+    const auto one = _mm_set1_ps(1.f);
+    const auto vdx = _mm_set1_ps(dx);
+    const auto vex = _mm_set1_ps(ex);
+    const auto vey = _mm_set1_ps(ey);
+    const auto vdxe = _mm_set1_ps(dx * ex);
+    const auto vinv = _mm_set1_ps(invLength2);
+    const auto vreach = _mm_set1_ps(reach);
+    const auto steps = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+
+    for(; j + 4 <= rows; j += 4){
+        auto dy = _mm_add_ps(_mm_set1_ps(dy0 + static_cast<float>(j)), steps);
+        //projection onto the segment, clamped to its ends
+        auto t = _mm_mul_ps(_mm_add_ps(vdxe, _mm_mul_ps(dy, vey)), vinv);
+        t = _mm_min_ps(_mm_max_ps(t, zero), one);
+        auto qx = _mm_sub_ps(vdx, _mm_mul_ps(t, vex));
+        auto qy = _mm_sub_ps(dy, _mm_mul_ps(t, vey));
+        auto distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)));
+        auto c = _mm_min_ps(_mm_max_ps(_mm_sub_ps(vreach, distance), zero), one);
+        _mm_storeu_ps(coverage + j, _mm_max_ps(_mm_loadu_ps(coverage + j), c));
+    }
+    addCoverage(coverage, j, rows, dy0, dx, ex, ey, invLength2, reach);
+}
+#endif
+
+#if SIMPLEEQ_AVX2
+//eight rows per step with the projection and distance as fused multiply-adds
+SIMPLEEQ_TARGET_AVX2
+static void coverSegmentAVX2(float* coverage, int rows, float dy0, float dx, float ex, float ey, float invLength2,
+                             float reach){
+    int j = 0;
+    const auto zero = _mm256_setzero_ps();
+    const auto one = _mm256_set1_ps(1.f);
+    const auto vdx = _mm256_set1_ps(dx);
+    const auto vex = _mm256_set1_ps(ex);
+    const auto vey = _mm256_set1_ps(ey);
+    const auto vdxe = _mm256_set1_ps(dx * ex);
+    const auto vinv = _mm256_set1_ps(invLength2);
+    const auto vreach = _mm256_set1_ps(reach);
+    const auto steps = _mm256_set_ps(7.f, 6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+
+    for(; j + 8 <= rows; j += 8){
+        auto dy = _mm256_add_ps(_mm256_set1_ps(dy0 + static_cast<float>(j)), steps);
+        auto t = _mm256_mul_ps(_mm256_fmadd_ps(dy, vey, vdxe), vinv);
+        t = _mm256_min_ps(_mm256_max_ps(t, zero), one);
+        auto qx = _mm256_fnmadd_ps(t, vex, vdx);
+        auto qy = _mm256_fnmadd_ps(t, vey, dy);
+        auto distance = _mm256_sqrt_ps(_mm256_fmadd_ps(qy, qy, _mm256_mul_ps(qx, qx)));
+        auto c = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(vreach, distance), zero), one);
+        _mm256_storeu_ps(coverage + j, _mm256_max_ps(_mm256_loadu_ps(coverage + j), c));
+    }
+    addCoverage(coverage, j, rows, dy0, dx, ex, ey, invLength2, reach);
+}
+#endif
+
+#if JUCE_ARM && defined(__ARM_NEON)
+static void coverSegmentNEON(float* coverage, int rows, float dy0, float dx, float ex, float ey, float invLength2,
+                             float reach){
+    int j = 0;
+    const auto zero = vdupq_n_f32(0.f);
+    const auto one = vdupq_n_f32(1.f);
+    const auto vdx = vdupq_n_f32(dx);
+    const auto vex = vdupq_n_f32(ex);
+    const auto vey = vdupq_n_f32(ey);
+    const auto vdxe = vdupq_n_f32(dx * ex);
+    const auto vinv = vdupq_n_f32(invLength2);
+    const auto vreach = vdupq_n_f32(reach);
+    const float stepValues[4] = { 0.f, 1.f, 2.f, 3.f };
+    const auto steps = vld1q_f32(stepValues);
+
+    for(; j + 4 <= rows; j += 4){
+        auto dy = vaddq_f32(vdupq_n_f32(dy0 + static_cast<float>(j)), steps);
+        auto t = vmulq_f32(vmlaq_f32(vdxe, dy, vey), vinv);
+        t = vminq_f32(vmaxq_f32(t, zero), one);
+        auto qx = vmlsq_f32(vdx, t, vex);
+        auto qy = vmlsq_f32(dy, t, vey);
+        //no vector square root on 32 bit NEON, the reciprocal estimate with two Newton steps is well below a
+        //coverage step, the offset keeps it finite on the segment itself
+        auto distance2 = vaddq_f32(vmlaq_f32(vmulq_f32(qx, qx), qy, qy), vdupq_n_f32(1.0e-12f));
+        auto estimate = vrsqrteq_f32(distance2);
+        estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(distance2, estimate), estimate));
+        estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(distance2, estimate), estimate));
+        auto distance = vmulq_f32(distance2, estimate);
+        auto c = vminq_f32(vmaxq_f32(vsubq_f32(vreach, distance), zero), one);
+        vst1q_f32(coverage + j, vmaxq_f32(vld1q_f32(coverage + j), c));
+    }
+    addCoverage(coverage, j, rows, dy0, dx, ex, ey, invLength2, reach);
+}
+#endif
+
+void coverSegment(float* coverage, int rows, float dy0, float dx, float ex, float ey, float invLength2, float reach){
+   #if JUCE_INTEL
+    coverSegmentSSE2(coverage, rows, dy0, dx, ex, ey, invLength2, reach);
+   #elif JUCE_ARM && defined(__ARM_NEON)
+    coverSegmentNEON(coverage, rows, dy0, dx, ex, ey, invLength2, reach);
+   #else
+    coverSegmentScalar(coverage, rows, dy0, dx, ex, ey, invLength2, reach);
+   #endif
+}
+
+CoverageKernel getCoverageKernel(IsaLevel isa){
+    switch(isa){
+       #if JUCE_INTEL
+        case IsaLevel::SSE2:
+            return coverSegmentSSE2;
+       #endif
+       #if SIMPLEEQ_AVX2
+        case IsaLevel::AVX2:
+            return coverSegmentAVX2;
+       #endif
+       #if JUCE_ARM && defined(__ARM_NEON)
+        case IsaLevel::NEON:
+            return coverSegmentNEON;
+       #endif
+        default:
+            return coverSegmentScalar;
+    }
+}
+
+bool TraceRaster::begin(juce::Rectangle<int> plotArea, juce::Rectangle<int> clipBounds, float physicalScale){
+    bitmap.reset();
+    if(plotArea.isEmpty() || physicalScale <= 0.f){
+        return false;
+    }
+    area = plotArea;
+    scale = physicalScale;
+
+    auto width = juce::roundToInt((area.getWidth() + 2 * Margin) * scale);
+    auto height = juce::roundToInt((area.getHeight() + 2 * Margin) * scale);
+    if(layer.getWidth() != width || layer.getHeight() != height){
+        //software image, the pixels are written directly through BitmapData
+        layer = juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    }
+
+    //the clip in layer pixels, rounded outwards, only this part is cleared, drawn and blitted
+    auto origin = area.getPosition() - juce::Point<int>(Margin, Margin);
+    auto clip = (clipBounds - origin).toFloat() * scale;
+    dirty = juce::Rectangle<int>::leftTopRightBottom(static_cast<int>(std::floor(clip.getX())),
+                                                     static_cast<int>(std::floor(clip.getY())),
+                                                     static_cast<int>(std::ceil(clip.getRight())),
+                                                     static_cast<int>(std::ceil(clip.getBottom())))
+                .getIntersection(layer.getBounds());
+    if(! dirty.isEmpty()){
+        layer.clear(dirty);
+    }
+
+    coverage.resize(static_cast<size_t>(height));
+    bitmap = std::make_unique<juce::Image::BitmapData>(layer, juce::Image::BitmapData::readWrite);
+    return true;
+}
+
+void TraceRaster::drawPolyline(const float* ys, int first, int numPoints, float strokeWidth, juce::Colour colour){
+    if(bitmap == nullptr || dirty.isEmpty() || numPoints < 1){
+        return;
+    }
+
+    auto reach = 0.5f * strokeWidth * scale + 0.5f;
+
+    //vertices in layer pixels
+    vertexX.resize(static_cast<size_t>(numPoints));
+    vertexY.resize(static_cast<size_t>(numPoints));
+    for(int i = 0; i < numPoints; ++i){
+        vertexX[static_cast<size_t>(i)] = static_cast<float>(first + i + Margin) * scale;
+        vertexY[static_cast<size_t>(i)] = (ys[i] - static_cast<float>(area.getY() - Margin)) * scale;
+    }
+
+    //a single point is drawn as a dot, a segment of zero length
+    auto numSegments = juce::jmax(1, numPoints - 1);
+    auto lastSegment = numSegments - 1;
+    auto segmentAt = [&](float x){
+        return juce::jlimit(0, lastSegment, static_cast<int>(std::floor(x / scale)) - first - Margin);
+    };
+
+    //columns and rows outside the clip are neither drawn nor blitted
+    auto firstColumn = juce::jmax(dirty.getX(), static_cast<int>(std::floor(vertexX.front() - reach)));
+    auto lastColumn = juce::jmin(dirty.getRight() - 1, static_cast<int>(std::ceil(vertexX.back() + reach)));
+
+    auto pixel = colour.getPixelARGB();
+
+    for(int column = firstColumn; column <= lastColumn; ++column){
+        auto centreX = static_cast<float>(column) + 0.5f;
+        auto firstSegment = segmentAt(centreX - reach);
+        auto endSegment = segmentAt(centreX + reach) + 1;
+
+        //rows any of the segments within reach of the column can touch
+        auto top = std::numeric_limits<float>::max();
+        auto bottom = std::numeric_limits<float>::lowest();
+        for(int k = firstSegment; k < endSegment; ++k){
+            auto b = juce::jmin(k + 1, numPoints - 1);
+            top = juce::jmin(top, vertexY[static_cast<size_t>(k)], vertexY[static_cast<size_t>(b)]);
+            bottom = juce::jmax(bottom, vertexY[static_cast<size_t>(k)], vertexY[static_cast<size_t>(b)]);
+        }
+        auto firstRow = juce::jmax(dirty.getY(), static_cast<int>(std::floor(top - reach)));
+        auto endRow = juce::jmin(dirty.getBottom(), static_cast<int>(std::ceil(bottom + reach)));
+        if(firstRow >= endRow){
+            continue;
+        }
+
+        auto* columnCoverage = coverage.data() + firstRow;
+        std::fill(columnCoverage, columnCoverage + (endRow - firstRow), 0.f);
+
+        for(int k = firstSegment; k < endSegment; ++k){
+            auto b = juce::jmin(k + 1, numPoints - 1);
+            auto ax = vertexX[static_cast<size_t>(k)];
+            auto ay = vertexY[static_cast<size_t>(k)];
+            auto ex = vertexX[static_cast<size_t>(b)] - ax;
+            auto ey = vertexY[static_cast<size_t>(b)] - ay;
+            auto length2 = ex * ex + ey * ey;
+
+            auto segmentFirst = juce::jmax(firstRow, static_cast<int>(std::floor(juce::jmin(ay, ay + ey) - reach)));
+            auto segmentEnd = juce::jmin(endRow, static_cast<int>(std::ceil(juce::jmax(ay, ay + ey) + reach)));
+            if(segmentFirst < segmentEnd){
+                cover(coverage.data() + segmentFirst, segmentEnd - segmentFirst,
+                             static_cast<float>(segmentFirst) + 0.5f - ay, centreX - ax, ex, ey,
+                             length2 > 0.f ? 1.f / length2 : 0.f, reach);
+            }
+        }
+
+        //premultiplied colour scaled by coverage, blended over what earlier traces left in the layer
+        for(int row = firstRow; row < endRow; ++row){
+            auto alpha = juce::roundToInt(coverage[static_cast<size_t>(row)] * 255.f);
+            if(alpha == 0){
+                continue;
+            }
+            auto source = pixel;
+            source.multiplyAlpha(alpha);
+            reinterpret_cast<juce::PixelARGB*>(bitmap->getPixelPointer(column, row))->blend(source);
+        }
+    }
+}
+
+bool TraceRaster::drawTrace(const CurveTrace& trace, float strokeWidth, juce::Colour colour){
+    const auto& points = trace.points;
+    if(bitmap == nullptr || static_cast<int>(points.size()) != area.getWidth()
+       || points.front().x != static_cast<float>(area.getX())){
+        return false;
+    }
+
+    traceY.resize(points.size());
+    for(size_t i = 0; i < points.size(); ++i){
+        traceY[i] = points[i].y;
+    }
+
+    //each run between breaks is its own polyline, so a wrapped value does not draw a line across the plot
+    size_t start = 0;
+    for(auto next : trace.breaks){
+        drawPolyline(traceY.data() + start, static_cast<int>(start), static_cast<int>(next - start), strokeWidth, colour);
+        start = next;
+    }
+    drawPolyline(traceY.data() + start, static_cast<int>(start), static_cast<int>(points.size() - start),
+                 strokeWidth, colour);
+    return true;
+}
+
+void TraceRaster::end(juce::Graphics& g){
+    if(bitmap == nullptr){
+        return;
+    }
+    bitmap.reset();
+    if(dirty.isEmpty()){
+        return;
+    }
+    g.drawImageTransformed(layer.getClippedImage(dirty),
+                           juce::AffineTransform::translation(dirty.getPosition().toFloat())
+                           .scaled(1.f / scale)
+                           .translated(static_cast<float>(area.getX() - Margin),
+                                       static_cast<float>(area.getY() - Margin)));
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    TraceRaster.h
+    Scanline rasterizer for polylines with one point per pixel column
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "ResponseCurve.h"
+#include "CpuDispatch.h"
+
+#include <memory>
+#include <vector>
+
+//raises coverage[j] to the coverage of the row centre j pixels below the first one by the segment from a to a + e
+//dy0 and dx are the first row centre's offsets from a, invLength2 is 1 / |e|^2 (0 for a single point) and reach is
+//the stroke's half width plus half a pixel, the distance at which coverage falls to zero
+//this is the SSE2 build on Intel and the NEON build on ARM
+void coverSegment(float* coverage, int rows, float dy0, float dx, float ex, float ey, float invLength2, float reach);
+
+using CoverageKernel = void (*)(float*, int, float, float, float, float, float, float);
+
+//coverSegment built for the given instruction set, only pass levels isIsaSupported() accepts
+CoverageKernel getCoverageKernel(IsaLevel isa);
+
+//the analyzer and response curve traces are monotone in x with one vertex per column, so instead of going through
+//strokePath's general edge table they are rasterized here column by column into one ARGB layer
+//each pixel's coverage is its distance to the nearest segment within reach of its column, with the distances of
+//four rows computed at once, which gives the same round joins and anti-aliasing as a stroked path
+//the layer is kept at the context's physical scale and drawn once at the end of paint, so it is a single blit
+//only the part of it under the paint's clip is cleared, drawn and blitted, a repaint of a few columns costs a few columns
+class TraceRaster{
+public:
+    //room around the plot area for the strokes' width and anti-aliasing
+    static constexpr int Margin = 2;
+
+    //message thread, from paint: sizes the layer to area at scale and clears the part of it inside clipBounds
+    //returns false if there is nothing to draw into, the caller strokes its paths instead
+    bool begin(juce::Rectangle<int> area, juce::Rectangle<int> clipBounds, float scale);
+
+    //strokes the polyline through ys, point i is at x = area.getX() + first + i in the coordinates of begin()
+    void drawPolyline(const float* ys, int first, int numPoints, float strokeWidth, juce::Colour colour);
+
+    //strokes a curve trace, split at its breaks
+    //returns false if the trace is not one point per column of the area, which happens for a frame or two after a
+    //resize until the worker catches up, the caller then strokes the trace's path
+    bool drawTrace(const CurveTrace& trace, float strokeWidth, juce::Colour colour);
+
+    //draws the layer into g and releases it until the next begin()
+    void end(juce::Graphics& g);
+
+    //message thread: picks the coverage kernel build, normally for the processor's getIsaLevel()
+    void setIsaLevel(IsaLevel isa) { cover = getCoverageKernel(isa); }
+
+private:
+    juce::Image layer;
+    std::unique_ptr<juce::Image::BitmapData> bitmap;
+    juce::Rectangle<int> area;
+    float scale { 1.f };
+    //layer pixels inside the clip given to begin()
+    juce::Rectangle<int> dirty;
+
+    //coverage of the rows of the column being drawn, physical vertices of the polyline and y values of a trace
+    std::vector<float> coverage, vertexX, vertexY, traceY;
+
+    CoverageKernel cover { coverSegment };
+};
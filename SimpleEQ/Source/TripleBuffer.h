@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Wait-free hand over of the latest value from one writer thread to one reader thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+//the writer fills its back slot and swaps it with the middle slot, the reader swaps its front slot with the middle
+//slot only when something new was published, so neither side ever waits and the reader always sees the latest value
+//slots are reused, so a T holding vectors keeps its allocations between frames
+template<typename T>
+struct TripleBuffer{
+    //writer: slot to fill before publish()
+    T& getWriteSlot() { return slots[backIndex]; }
+
+    void publish(){
+        auto previous = middle.exchange(backIndex | NewDataFlag, std::memory_order_acq_rel);
+        backIndex = previous & IndexMask;
+    }
+
+    //reader: takes the latest published value if there is one, returns false if nothing new arrived
+    bool pull(){
+        if((middle.load(std::memory_order_relaxed) & NewDataFlag) == 0){
+            return false;
+        }
+        auto previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & IndexMask;
+        return true;
+    }
+
+    //reader: most recently pulled value
+    const T& getReadSlot() const { return slots[frontIndex]; }
+
+private:
+    static constexpr int IndexMask = 3;
+    static constexpr int NewDataFlag = 4;
+
+    std::array<T, 3> slots;
+    int backIndex = 0;
+    int frontIndex = 1;
+    std::atomic<int> middle { 2 };
+};
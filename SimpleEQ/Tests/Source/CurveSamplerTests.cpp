@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    CurveSamplerTests.cpp
+    Sampled and reconstructed band responses against every column evaluated
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../../Source/CurveSampler.h"
+#include "../../Source/ResponseEvaluator.h"
+#include "../../Source/StereoDesign.h"
+
+//the sampler's check points are a heuristic, so its error is measured here the way the curve worker uses it: same
+//plot size, tolerances and seeds around the band's frequency, over randomised bands of every kind the editor has
+class CurveSamplerTests : public juce::UnitTest{
+public:
+    CurveSamplerTests() : juce::UnitTest("CurveSampler", "SimpleEQ") {}
+
+    void runTest() override{
+        for(auto sampleRate : {48000.0, 192000.0}){
+            beginTest("reconstruction error against dense evaluation, " + juce::String(sampleRate, 0) + " Hz");
+
+            std::vector<double> frequencies;
+            for(int i = 0; i < Width; ++i){
+                frequencies.push_back(juce::mapToLog10(static_cast<double>(i) / Width, 20.0, 20000.0));
+            }
+            ResponseTable table;
+            table.build(frequencies, sampleRate);
+
+            juce::Random random(42);
+            float worstPixels = 0.f;
+            int totalColumns = 0;
+
+            for(int band = 0; band < NumBands; ++band){
+                auto frequency = juce::mapToLog10(random.nextFloat(), 20.f, 20000.f);
+                std::array<StereoSection, 4> sections;
+                int numSections = 1;
+
+                switch(band % 3){
+                    case 0:
+                    case 1:{
+                        //low and high cuts of every slope, the inactive sections are passthrough and left in
+                        auto slope = random.nextInt(4);
+                        designCutSections(sections.data(), band % 3 == 0, sampleRate, {frequency, frequency},
+                                          {slope, slope}, 1);
+                        numSections = 4;
+                        break;
+                    }
+                    default:{
+                        //Q skewed towards the narrow end, where a peak is hardest to sample
+                        auto quality = 0.1f + 9.9f * random.nextFloat() * random.nextFloat();
+                        auto gain = random.nextFloat() * 48.f - 24.f;
+                        designPeakSection(sections[0], sampleRate, {frequency, frequency}, {quality, quality},
+                                          {gain, gain}, 1);
+                        break;
+                    }
+                }
+
+                Trace exact, sampled;
+                evaluateColumns(table, sections.data(), numSections, exact);
+                totalColumns += sample(table, sections.data(), numSections, frequency, sampleRate, sampled);
+
+                for(size_t i = 0; i < static_cast<size_t>(Width); ++i){
+                    //only levels the plot can show count, like the sampler's floor
+                    auto decibels = std::abs(juce::jmax(-48.f, sampled.decibels[i])
+                                             - juce::jmax(-48.f, exact.decibels[i]));
+                    auto phase = std::abs(std::remainder(sampled.phase[i] - exact.phase[i],
+                                                         juce::MathConstants<float>::twoPi));
+                    auto delay = std::abs(sampled.delay[i] - exact.delay[i]);
+                    worstPixels = juce::jmax(worstPixels,
+                                             decibels * pixelsPerDecibel(),
+                                             phase * pixelsPerRadian(),
+                                             delay * pixelsPerSample(sampleRate));
+                }
+            }
+
+            logMessage("worst error " + juce::String(worstPixels, 3) + " px, "
+                       + juce::String(static_cast<double>(totalColumns) / NumBands, 1) + " of "
+                       + juce::String(Width) + " columns evaluated per band");
+            //the check points accept up to TolerancePixels, half a pixel leaves room for the error between them
+            expectLessOrEqual(worstPixels, 0.5f, "worst error in pixels");
+            expectLessOrEqual(totalColumns, NumBands * Width / 2, "columns evaluated");
+        }
+    }
+
+private:
+    static constexpr int Width = 580, NumBands = 600;
+    static constexpr float Height = 300.f, MaxGroupDelayMs = 50.f;
+
+    //the curve worker's scales for its three traces
+    static float pixelsPerDecibel() { return Height / 48.f; }
+    static float pixelsPerRadian() { return Height / juce::MathConstants<float>::twoPi; }
+    static float pixelsPerSample(double sampleRate){
+        return Height / (2.f * MaxGroupDelayMs) * static_cast<float>(1000.0 / sampleRate);
+    }
+
+    struct Trace{
+        std::vector<float> decibels, phase, delay;
+    };
+
+    static void evaluateColumns(const ResponseTable& table, const StereoSection* sections, int numSections,
+                                Trace& trace){
+        auto n = table.size();
+        ResponseColumns response;
+        response.reset(n);
+        accumulateSectionResponse(sections, numSections, 0, table, response);
+
+        std::vector<float> power(static_cast<size_t>(n));
+        trace.decibels.resize(power.size());
+        trace.phase.resize(power.size());
+        computeResponsePowers(response, power.data());
+        computeResponsePhases(response, trace.phase.data());
+        for(size_t i = 0; i < power.size(); ++i){
+            trace.decibels[i] = juce::jmax(-60.f, 10.f * std::log10(juce::jmax(power[i], 1.0e-30f)));
+        }
+        trace.delay = response.groupDelay;
+    }
+
+    //returns the number of columns the sampler asked for
+    static int sample(const ResponseTable& table, const StereoSection* sections, int numSections, float frequency,
+                      double sampleRate, Trace& trace){
+        CurveSampler sampler;
+        sampler.setTrace(0, pixelsPerDecibel(), 0.f, -54.f);
+        sampler.setTrace(1, pixelsPerRadian(), juce::MathConstants<float>::twoPi);
+        sampler.setTrace(2, pixelsPerSample(sampleRate));
+
+        std::vector<int> seeds;
+        auto centre = juce::roundToInt(static_cast<float>(Width) * std::log10(frequency / 20.f) / 3.f);
+        for(int offset = -12; offset <= 12; offset += 2){
+            seeds.push_back(centre + offset);
+        }
+
+        int numEvaluated = 0;
+        sampler.begin(Width, 3, seeds);
+        while(! sampler.isDone()){
+            ResponseTable subset;
+            subset.gather(table, sampler.getPendingColumns());
+            Trace values;
+            evaluateColumns(subset, sections, numSections, values);
+            numEvaluated += subset.size();
+            sampler.supply({values.decibels.data(), values.phase.data(), values.delay.data()});
+        }
+
+        for(auto* output : {&trace.decibels, &trace.phase, &trace.delay}){
+            output->resize(static_cast<size_t>(Width));
+        }
+        sampler.reconstruct(0, trace.decibels.data());
+        sampler.reconstruct(1, trace.phase.data());
+        sampler.reconstruct(2, trace.delay.data());
+        return numEvaluated;
+    }
+};
+
+static CurveSamplerTests curveSamplerTests;
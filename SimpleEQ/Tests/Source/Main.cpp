@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Runs the SimpleEQ unit tests and returns non-zero if any of them failed
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+//the tests register themselves through their static instances in the other files of this project
+int main(){
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("SimpleEQ");
+
+    int failures = 0;
+    for(int i = 0; i < runner.getNumResults(); ++i){
+        failures += runner.getResult(i)->failures;
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    ResponseEvaluatorTests.cpp
+    Float response evaluation against a double precision reference near DC
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../../Source/ResponseEvaluator.h"
+#include "../../Source/StereoDesign.h"
+
+#include <complex>
+
+//the float evaluation is compared with the same float coefficients evaluated in double, so only the evaluation error
+//is measured, not the coefficient quantization
+//the columns sit around a low cut at high sample rates, where w is tiny and 1 + a1 cos w + a2 cos 2w would cancel
+class ResponseEvaluatorTests : public juce::UnitTest{
+public:
+    ResponseEvaluatorTests() : juce::UnitTest("ResponseEvaluator", "SimpleEQ") {}
+
+    void runTest() override{
+        //every build this CPU can run, the vector ones each have their own float error to stay within tolerance
+        for(auto isa : {IsaLevel::Scalar, IsaLevel::SSE2, IsaLevel::AVX2, IsaLevel::NEON}){
+            if(! isIsaSupported(isa)){
+                continue;
+            }
+            auto kernel = getSectionResponseKernel(isa);
+
+            for(auto sampleRate : {44100.0, 96000.0, 192000.0}){
+                auto where = juce::String(sampleRate, 0) + " Hz, " + getIsaName(isa);
+
+                beginTest("48 dB/Oct low cut at 20 Hz, " + where);
+                //slope 3 is the 48 dB/Oct choice, four second order sections
+                std::array<StereoSection, 4> sections;
+                designCutSections(sections.data(), true, sampleRate, {20.f, 20.f}, {3, 3}, 1);
+                checkAgainstReference(kernel, sections.data(), static_cast<int>(sections.size()), sampleRate,
+                                      10.0, 200.0);
+
+                beginTest("low peak over the audio band, " + where);
+                StereoSection peak;
+                designPeakSection(peak, sampleRate, {30.f, 30.f}, {0.5f, 0.5f}, {12.f, 12.f}, 1);
+                checkAgainstReference(kernel, &peak, 1, sampleRate, 10.0, 20000.0);
+            }
+        }
+    }
+
+private:
+    static constexpr int NumColumns = 64;
+
+    void checkAgainstReference(SectionResponseKernel kernel, const StereoSection* sections, int numSections,
+                               double sampleRate, double lowestFrequency, double highestFrequency){
+        std::vector<double> frequencies;
+        for(int i = 0; i < NumColumns; ++i){
+            auto proportion = static_cast<double>(i) / (NumColumns - 1);
+            frequencies.push_back(lowestFrequency * std::pow(highestFrequency / lowestFrequency, proportion));
+        }
+
+        ResponseTable table;
+        table.build(frequencies, sampleRate);
+        ResponseColumns response;
+        response.reset(NumColumns);
+        kernel(sections, numSections, 0, table, response);
+
+        std::vector<float> power(NumColumns), phase(NumColumns);
+        computeResponsePowers(response, power.data());
+        computeResponsePhases(response, phase.data());
+
+        for(int i = 0; i < NumColumns; ++i){
+            auto column = static_cast<size_t>(i);
+            auto w = juce::MathConstants<double>::twoPi * frequencies[column] / sampleRate;
+            auto z = std::polar(1.0, -w);
+
+            //H and the group delay sum over sections of Re(z P'(z) / P(z)) for numerator and denominator
+            std::complex<double> h = 1.0;
+            double groupDelay = 0.0;
+            for(int s = 0; s < numSections; ++s){
+                const auto& section = sections[s];
+                double b0 = section.b0[0], b1 = section.b1[0], b2 = section.b2[0];
+                double a1 = section.a1[0], a2 = section.a2[0];
+                auto numerator = b0 + b1 * z + b2 * z * z;
+                auto denominator = 1.0 + a1 * z + a2 * z * z;
+                h *= numerator / denominator;
+                groupDelay += std::real((b1 * z + 2.0 * b2 * z * z) / numerator)
+                            - std::real((a1 * z + 2.0 * a2 * z * z) / denominator);
+            }
+
+            auto where = juce::String(frequencies[column], 1) + " Hz";
+            expectWithinAbsoluteError(10.0 * std::log10(static_cast<double>(power[column])),
+                                      10.0 * std::log10(std::norm(h)), 0.05, "magnitude at " + where);
+            expectWithinAbsoluteError(std::remainder(static_cast<double>(phase[column]) - std::arg(h),
+                                                     juce::MathConstants<double>::twoPi),
+                                      0.0, 0.01, "phase at " + where);
+            expectWithinAbsoluteError(static_cast<double>(response.groupDelay[column]), groupDelay,
+                                      0.005 * juce::jmax(1.0, std::abs(groupDelay)), "group delay at " + where);
+        }
+    }
+};
+
+static ResponseEvaluatorTests responseEvaluatorTests;
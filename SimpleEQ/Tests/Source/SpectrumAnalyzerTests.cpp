@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzerTests.cpp
+    Analyzer levels of white noise through the handovers between decimated stages
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../../Source/SpectrumAnalyzer.h"
+
+//white noise has the same density at every frequency, so its trace has to be flat through every handover from one
+//stage to the next, where a normalization that ignores the stage's bin width shows a 3 dB step
+//the analyzer runs on its own thread as in the editor, fed through the FIFOs the way processBlock feeds them
+class SpectrumAnalyzerTests : public juce::UnitTest{
+public:
+    SpectrumAnalyzerTests() : juce::UnitTest("SpectrumAnalyzer", "SimpleEQ") {}
+
+    void runTest() override{
+        for(auto sampleRate : {48000.0, 96000.0}){
+            beginTest("white noise across the stage handovers, " + juce::String(sampleRate, 0) + " Hz");
+            analyzeNoise(sampleRate);
+
+            //uniform noise in -1..1 has a variance of 1/3 per channel, mid and side of two independent channels half
+            //that, levels are the density in one stage 0 bin, so the variance over fftSize / 2 bins
+            auto channelLevel = 10.0 * std::log10(1.0 / 3.0 / (FFTSize / 2));
+            std::array<double, NumAnalyzerTraces> expected {channelLevel, channelLevel,
+                                                            channelLevel - 3.0103, channelLevel - 3.0103};
+
+            for(size_t trace = 0; trace < NumAnalyzerTraces; ++trace){
+                const auto& power = averagePower[trace];
+
+                //every column over the band where each has enough bins to settle
+                double worst = 0.0;
+                for(int x = 0; x < Width; ++x){
+                    if(frequencyOf(x) >= 200.0){
+                        worst = juce::jmax(worst, std::abs(toDecibels(power[static_cast<size_t>(x)]) - expected[trace]));
+                    }
+                }
+                logMessage("trace " + juce::String(static_cast<int>(trace)) + " worst deviation "
+                           + juce::String(worst, 2) + " dB");
+                expectLessOrEqual(worst, 1.0, "deviation from the expected density");
+
+                //the handover from stage k to k - 1 is where a column's band reaches past stage k's clean band
+                for(int k = 1; k < SpectrumAnalyzer::NumStages; ++k){
+                    auto handover = HalfBandDecimator::UsableBandwidth * sampleRate / (2 << k);
+                    auto below = meanDecibels(power, handover / 1.5, handover / 1.2);
+                    auto above = meanDecibels(power, handover * 1.05, handover * 1.3);
+                    expectWithinAbsoluteError(above, below, 0.5,
+                                              "step at the handover to stage " + juce::String(k - 1)
+                                              + ", " + juce::String(handover, 0) + " Hz");
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int Width = 580, FFTOrder = 12, FFTSize = 1 << FFTOrder, BlockSize = 512;
+    //stage 3 runs at an eighth of the rate, so this is about 50 of its hops at 75 % overlap, and at least as many
+    //frames are averaged however the analyzer thread is scheduled
+    static constexpr int NumBlocks = 800, NumFrames = 100;
+
+    using Fifo = SpectrumAnalyzer::Fifo;
+
+    //per post EQ trace the linear density of each column averaged over the frames
+    std::array<std::vector<double>, NumAnalyzerTraces> averagePower;
+
+    static double frequencyOf(int x){
+        //centre of the column, as the analyzer places it
+        auto start = juce::mapToLog10(static_cast<double>(x) / Width, 20.0, 20000.0);
+        auto end = juce::mapToLog10(static_cast<double>(x + 1) / Width, 20.0, 20000.0);
+        return std::sqrt(start * end);
+    }
+
+    static double toDecibels(double power) { return 10.0 * std::log10(juce::jmax(power, 1.0e-30)); }
+
+    static double meanDecibels(const std::vector<double>& power, double lowHz, double highHz){
+        double sum = 0.0;
+        int count = 0;
+        for(int x = 0; x < Width; ++x){
+            auto frequency = frequencyOf(x);
+            if(frequency >= lowHz && frequency <= highHz){
+                sum += power[static_cast<size_t>(x)];
+                ++count;
+            }
+        }
+        return toDecibels(sum / juce::jmax(1, count));
+    }
+
+    void analyzeNoise(double sampleRate){
+        Fifo leftPre(Left), rightPre(Right), leftPost(Left), rightPost(Right);
+        std::array<Fifo*, 4> fifos {&leftPre, &rightPre, &leftPost, &rightPost};
+        for(auto* fifo : fifos){
+            fifo->prepare();
+        }
+
+        SpectrumAnalyzer analyzer(leftPre, rightPre, leftPost, rightPost);
+        analyzer.setSampleRate(sampleRate);
+        analyzer.setDisplayWidth(Width);
+        analyzer.setFFTOrder(FFTOrder);
+        analyzer.setOverlap(0.75f);
+        analyzer.setSmoothing(3);
+        analyzer.startThread();
+
+        for(auto& power : averagePower){
+            power.assign(static_cast<size_t>(Width), 0.0);
+        }
+
+        juce::AudioBuffer<float> block(2, BlockSize);
+        juce::Random random(7);
+        int numBlocks = 0, numFrames = 0;
+        //until stage 3 has a full window of noise its levels are still partly silence, this leaves room for the
+        //analyzer to be a whole FIFO behind
+        auto warmUpBlocks = 4 * FFTSize * (1 << (SpectrumAnalyzer::NumStages - 1)) / BlockSize;
+        auto deadline = juce::Time::getMillisecondCounter() + 20000;
+
+        while((numBlocks < NumBlocks || numFrames < NumFrames) && juce::Time::getMillisecondCounter() < deadline){
+            //nothing is dropped, so all four FIFOs keep the same blocks without processBlock's early stop
+            auto full = std::any_of(fifos.begin(), fifos.end(), [](const Fifo* f){
+                return f->getNumCompleteBuffersAvailable() > 64;
+            });
+            if(full){
+                juce::Thread::sleep(1);
+            }
+            else{
+                for(int ch = 0; ch < 2; ++ch){
+                    auto* samples = block.getWritePointer(ch);
+                    for(int i = 0; i < BlockSize; ++i){
+                        samples[i] = random.nextFloat() * 2.f - 1.f;
+                    }
+                }
+                for(auto* fifo : fifos){
+                    fifo->update(block);
+                }
+                ++numBlocks;
+            }
+
+            if(analyzer.pullLatest() && numBlocks > warmUpBlocks){
+                accumulate(analyzer.getLatest());
+                ++numFrames;
+            }
+        }
+
+        analyzer.stopThread(1000);
+        logMessage(juce::String(numFrames) + " frames averaged");
+        expectGreaterOrEqual(numFrames, NumFrames, "frames averaged");
+        for(auto& power : averagePower){
+            for(auto& value : power){
+                value /= juce::jmax(1, numFrames);
+            }
+        }
+    }
+
+    void accumulate(const AnalyzerFrame& frame){
+        for(size_t trace = 0; trace < NumAnalyzerTraces; ++trace){
+            const auto& levels = frame.levels[Tap_Post][trace];
+            for(size_t x = 0; x < levels.size() && x < averagePower[trace].size(); ++x){
+                averagePower[trace][x] += std::pow(10.0, levels[x] / 10.0);
+            }
+        }
+    }
+};
+
+static SpectrumAnalyzerTests spectrumAnalyzerTests;